@@ -0,0 +1,1095 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "arrow.h"
+#include "logger.h"
+#include "metrics.h"
+#include "shared.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+
+// Flatbuffers and Arrow buffers are little-endian, values are copied as they are in memory.
+static_assert(std::endian::native == std::endian::little, "Arrow IPC requires a little-endian host");
+
+namespace {
+    constexpr u32 CONTINUATION{0xFFFF'FFFF};
+    constexpr size_t ALIGNMENT{8};
+    /// Larger metadata is treated as garbage.
+    constexpr u32 MAX_METADATA{64 << 20};
+    /// Key of the field's custom metadata with the declared SQLite type of the column.
+    constexpr std::string_view DECLARED_TYPE_KEY{"sqlite:declared_type"};
+
+    // MetadataVersion
+    constexpr i16 METADATA_V4{3};
+    constexpr i16 METADATA_V5{4};
+    // MessageHeader union
+    constexpr u8 HEADER_SCHEMA{1};
+    constexpr u8 HEADER_RECORD_BATCH{3};
+    // Type union
+    constexpr u8 TYPE_NULL{1};
+    constexpr u8 TYPE_INT{2};
+    constexpr u8 TYPE_FLOATING_POINT{3};
+    constexpr u8 TYPE_BINARY{4};
+    constexpr u8 TYPE_UTF8{5};
+    constexpr u8 TYPE_BOOL{6};
+    constexpr u8 TYPE_LARGE_BINARY{19};
+    constexpr u8 TYPE_LARGE_UTF8{20};
+    // Precision
+    constexpr i16 PRECISION_SINGLE{1};
+    constexpr i16 PRECISION_DOUBLE{2};
+
+    // Slots (field ids) of tables.
+    constexpr u16 MESSAGE_VERSION{0};
+    constexpr u16 MESSAGE_HEADER_TYPE{1};
+    constexpr u16 MESSAGE_HEADER{2};
+    constexpr u16 MESSAGE_BODY_LENGTH{3};
+    constexpr u16 SCHEMA_ENDIANNESS{0};
+    constexpr u16 SCHEMA_FIELDS{1};
+    constexpr u16 FIELD_NAME{0};
+    constexpr u16 FIELD_NULLABLE{1};
+    constexpr u16 FIELD_TYPE_TYPE{2};
+    constexpr u16 FIELD_TYPE{3};
+    constexpr u16 FIELD_DICTIONARY{4};
+    constexpr u16 FIELD_CHILDREN{5};
+    constexpr u16 FIELD_CUSTOM_METADATA{6};
+    constexpr u16 KEY_VALUE_KEY{0};
+    constexpr u16 KEY_VALUE_VALUE{1};
+    constexpr u16 INT_BIT_WIDTH{0};
+    constexpr u16 INT_IS_SIGNED{1};
+    constexpr u16 FLOATING_POINT_PRECISION{0};
+    constexpr u16 RECORD_BATCH_LENGTH{0};
+    constexpr u16 RECORD_BATCH_NODES{1};
+    constexpr u16 RECORD_BATCH_BUFFERS{2};
+    constexpr u16 RECORD_BATCH_COMPRESSION{3};
+
+    /// Structs of the RecordBatch.
+    struct FieldNode {
+        i64 length;
+        i64 null_count;
+    };
+    struct Buffer {
+        i64 offset;
+        i64 length;
+    };
+
+    template<typename T>
+    T load(u8 const* const ptr) noexcept {
+        T v;
+        std::memcpy(&v, ptr, sizeof(T));
+        return v;
+    }
+
+    /****************************************************************
+    *                                                               *
+    *                F L A T B U F F E R   B U I L D E R            *
+    *                                                               *
+    ****************************************************************/
+
+    /// Minimal flatbuffer builder (tables, scalars, strings, vectors of structs and offsets). \n
+    /// Like the original one, it writes from the end of the buffer to the beginning,
+    /// so referenced objects are written before objects referring to them.
+    /// Offsets (u32) are sizes of the data written so far, counted from the end.
+    class Builder {
+        std::vector<u8> buffer_ = std::vector<u8>(512);
+        size_t head_{buffer_.size()};   // the data is [head_, buffer_.size())
+        size_t min_align_{1};
+        std::vector<std::pair<u16,u32>> slots_{};
+        u32 table_start_{};
+    public:
+        [[nodiscard]] u32 size() const noexcept {
+            return static_cast<u32>(buffer_.size() - head_);
+        }
+
+        u32 string(std::string_view const s) {
+            prep(sizeof(u32), s.size() + 1);
+            put<u8>(0);
+            reserve(s.size());
+            head_ -= s.size();
+            std::memcpy(buffer_.data() + head_, s.data(), s.size());
+            put(static_cast<u32>(s.size()));
+            return size();
+        }
+        template<typename T>
+        u32 structs(std::span<T const> const items) {
+            prep(sizeof(u32), items.size() * sizeof(T));
+            prep(alignof(T), items.size() * sizeof(T));
+            for (auto it = items.rbegin(); it != items.rend(); ++it)
+                put(*it);
+            put(static_cast<u32>(items.size()));
+            return size();
+        }
+        u32 offsets(std::span<u32 const> const refs) {
+            prep(sizeof(u32), refs.size() * sizeof(u32));
+            for (auto it = refs.rbegin(); it != refs.rend(); ++it)
+                put(refer(*it));
+            put(static_cast<u32>(refs.size()));
+            return size();
+        }
+
+        void start_table() {
+            slots_.clear();
+            table_start_ = size();
+        }
+        template<typename T>
+        void add(u16 const slot, T const value) {
+            prep(sizeof(T), 0);
+            put(value);
+            slots_.emplace_back(slot, size());
+        }
+        void add_offset(u16 const slot, u32 const ref) {
+            prep(sizeof(u32), 0);
+            put(refer(ref));
+            slots_.emplace_back(slot, size());
+        }
+        /// Write the vtable and patch the table's offset to it.
+        u32 end_table() {
+            prep(sizeof(i32), 0);
+            put<i32>(0);
+            auto const object = size();
+
+            u16 count{};
+            for (auto const& [slot, _] : slots_)
+                count = std::max<u16>(count, slot + 1);
+            std::vector<u16> entries(count);
+            for (auto const& [slot, offset] : slots_)
+                entries[slot] = static_cast<u16>(object - offset);
+            for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+                put(*it);
+            put(static_cast<u16>(object - table_start_));
+            put(static_cast<u16>(sizeof(u16) * (2 + count)));
+
+            auto const vtable = static_cast<i32>(size());
+            auto const soffset = vtable - static_cast<i32>(object);
+            std::memcpy(buffer_.data() + buffer_.size() - object, &soffset, sizeof(soffset));
+            slots_.clear();
+            return object;
+        }
+        /// Write the offset of the root table, the result is padded to ALIGNMENT.
+        std::vector<u8> finish(u32 const root) {
+            prep(std::max(min_align_, ALIGNMENT), sizeof(u32));
+            put(refer(root));
+            std::vector<u8> out(buffer_.begin() + static_cast<std::ptrdiff_t>(head_), buffer_.end());
+            out.resize((out.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+            return out;
+        }
+
+    private:
+        void reserve(size_t const n) {
+            if (head_ >= n)
+                return;
+            auto const used = buffer_.size() - head_;
+            auto capacity = buffer_.size();
+            while (capacity - used < n)
+                capacity *= 2;
+            std::vector<u8> bigger(capacity);
+            std::copy(buffer_.begin() + static_cast<std::ptrdiff_t>(head_), buffer_.end(), bigger.end() - static_cast<std::ptrdiff_t>(used));
+            buffer_ = std::move(bigger);
+            head_ = buffer_.size() - used;
+        }
+        template<typename T>
+        void put(T const v) {
+            reserve(sizeof(T));
+            head_ -= sizeof(T);
+            std::memcpy(buffer_.data() + head_, &v, sizeof(T));
+        }
+        /// Padding such that after writing 'additional' bytes the size is a multiple of 'align'.
+        void prep(size_t const align, size_t const additional) {
+            min_align_ = std::max(min_align_, align);
+            auto const padding = (~(size() + additional) + 1) & (align - 1);
+            for (size_t i = 0; i < padding; ++i)
+                put<u8>(0);
+        }
+        /// Value of the offset written at the current position (aligned to 4) pointing at 'ref'.
+        [[nodiscard]] u32 refer(u32 const ref) const noexcept {
+            return size() + static_cast<u32>(sizeof(u32)) - ref;
+        }
+    };
+
+    /****************************************************************
+    *                                                               *
+    *                 F L A T B U F F E R   T A B L E               *
+    *                                                               *
+    ****************************************************************/
+
+    /// Read-only view of a flatbuffer table, every access is checked against the buffer's bounds.
+    /// Missing (or broken) scalar fields give the default value.
+    class Table {
+        std::span<const u8> buffer_;
+        size_t pos_;
+        size_t vtable_;
+        u16 vtable_size_;
+        u16 table_size_;
+
+        Table(std::span<const u8> const buffer, size_t const pos, size_t const vtable, u16 const vtable_size, u16 const table_size)
+            : buffer_{buffer}, pos_{pos}, vtable_{vtable}, vtable_size_{vtable_size}, table_size_{table_size} {}
+    public:
+        static std::optional<Table> root(std::span<const u8> const buffer) {
+            if (buffer.size() < sizeof(u32))
+                return {};
+            return at(buffer, load<u32>(buffer.data()));
+        }
+        static std::optional<Table> at(std::span<const u8> const buffer, u64 const pos) {
+            if (pos + sizeof(i32) > buffer.size())
+                return {};
+            auto const vtable = static_cast<i64>(pos) - load<i32>(buffer.data() + pos);
+            if (vtable < 0 || static_cast<u64>(vtable) + 2 * sizeof(u16) > buffer.size())
+                return {};
+            auto const vtable_size = load<u16>(buffer.data() + vtable);
+            auto const table_size = load<u16>(buffer.data() + vtable + sizeof(u16));
+            if (vtable_size < 2 * sizeof(u16) || static_cast<u64>(vtable) + vtable_size > buffer.size())
+                return {};
+            if (table_size < sizeof(i32) || pos + table_size > buffer.size())
+                return {};
+            return Table{buffer, static_cast<size_t>(pos), static_cast<size_t>(vtable), vtable_size, table_size};
+        }
+
+        template<typename T>
+        [[nodiscard]] T scalar(u16 const slot, T const otherwise) const noexcept {
+            auto const offset = field(slot);
+            if (!offset || offset + sizeof(T) > table_size_)
+                return otherwise;
+            return load<T>(buffer_.data() + pos_ + offset);
+        }
+        [[nodiscard]] std::optional<Table> table(u16 const slot) const {
+            if (auto const target = follow(slot))
+                return at(buffer_, *target);
+            return {};
+        }
+        [[nodiscard]] std::optional<std::string_view> string(u16 const slot) const {
+            if (auto const items = vector(slot, 1))
+                return std::string_view{reinterpret_cast<char const*>(buffer_.data() + items->first), items->second};
+            return {};
+        }
+        /// Position of the first element and the number of elements.
+        [[nodiscard]] std::optional<std::pair<size_t,u32>> vector(u16 const slot, size_t const element_size) const {
+            auto const target = follow(slot);
+            if (!target || *target + sizeof(u32) > buffer_.size())
+                return {};
+            auto const n = load<u32>(buffer_.data() + *target);
+            auto const first = *target + sizeof(u32);
+            if (first + u64{n} * element_size > buffer_.size())
+                return {};
+            return std::pair{static_cast<size_t>(first), n};
+        }
+        /// Table 'i' of the vector of tables starting at 'first'.
+        [[nodiscard]] std::optional<Table> element(size_t const first, size_t const i) const {
+            auto const pos = first + i * sizeof(u32);
+            return at(buffer_, pos + load<u32>(buffer_.data() + pos));
+        }
+        template<typename T>
+        [[nodiscard]] T item(size_t const first, size_t const i) const noexcept {
+            return load<T>(buffer_.data() + first + i * sizeof(T));
+        }
+
+    private:
+        [[nodiscard]] u16 field(u16 const slot) const noexcept {
+            auto const at = sizeof(u16) * (2 + slot);
+            return at + sizeof(u16) <= vtable_size_ ? load<u16>(buffer_.data() + vtable_ + at) : 0;
+        }
+        /// Position the offset field points at.
+        [[nodiscard]] std::optional<u64> follow(u16 const slot) const {
+            auto const offset = field(slot);
+            if (!offset || offset + sizeof(u32) > table_size_)
+                return {};
+            auto const pos = pos_ + offset;
+            return pos + u64{load<u32>(buffer_.data() + pos)};
+        }
+    };
+
+    /****************************************************************
+    *                                                               *
+    *                          H E L P E R S                        *
+    *                                                               *
+    ****************************************************************/
+
+    /// The type given by the column's declared type (SQLite affinity rules), none for NUMERIC.
+    std::optional<ipc::Type> declared_type(std::string_view const declared) {
+        std::string upper{declared};
+        std::ranges::transform(upper, upper.begin(), [](unsigned char const c) { return std::toupper(c); });
+        auto const has = [&upper](std::string_view const part) { return upper.find(part) != std::string::npos; };
+        if (has("INT"))
+            return ipc::INT64;
+        if (has("CHAR") || has("CLOB") || has("TEXT"))
+            return ipc::UTF8;
+        if (has("BLOB"))
+            return ipc::BINARY;
+        if (has("REAL") || has("FLOA") || has("DOUB"))
+            return ipc::FLOAT64;
+        return {};
+    }
+
+    /// The double is an integer in the range of i64.
+    bool integral(f64 const d) noexcept {
+        return std::trunc(d) == d && d >= -0x1p63 && d < 0x1p63;
+    }
+
+    /// The integer is exactly representable as a double.
+    bool exact_double(i64 const v) noexcept {
+        auto const d = static_cast<f64>(v);
+        return integral(d) && static_cast<i64>(d) == v;
+    }
+
+    /// All non-null cells of the column can be written as the type.
+    bool fits(ipc::Type const type, Column const& column) {
+        for (size_t row = 0; row < column.size(); ++row) {
+            auto const kind = column.kind(row);
+            if (kind == Value::MONOSTATE)
+                continue;
+            auto const ok = type == ipc::INT64 ? kind == Value::INTEGER
+                : type == ipc::FLOAT64 ? (kind == Value::INTEGER && exact_double(column.integer(row))) || kind == Value::DOUBLE
+                : type == ipc::UTF8 ? kind == Value::STRING
+                : kind == Value::VECTOR || kind == Value::STRING;
+            if (!ok)
+                return false;
+        }
+        return true;
+    }
+
+    ipc::Type choose_type(std::string_view const declared, Column const& column) {
+        if (auto const type = declared_type(declared); type && fits(*type, column))
+            return *type;
+
+        bool integer{}, real{}, text{}, blob{};
+        for (size_t row = 0; row < column.size(); ++row)
+            switch (column.kind(row)) {
+                case Value::INTEGER: integer = true; break;
+                case Value::DOUBLE: real = true; break;
+                case Value::STRING: text = true; break;
+                case Value::VECTOR: blob = true; break;
+                default: break;
+            }
+        if (blob)
+            return ipc::BINARY;
+        if (text)
+            return ipc::UTF8;
+        // Integers not representable as doubles are kept exactly as text.
+        if (real)
+            return fits(ipc::FLOAT64, column) ? ipc::FLOAT64 : ipc::UTF8;
+        if (integer)
+            return ipc::INT64;
+        return ipc::UTF8;
+    }
+
+    /// Body of the record batch: buffers aligned to ALIGNMENT and their locations.
+    struct Body {
+        std::vector<char> bytes{};
+        std::vector<Buffer> buffers{};
+
+        /// Append the buffer of 'n' zeroed bytes, returns its data.
+        char* add(size_t const n) {
+            auto const offset = bytes.size();
+            bytes.resize(offset + (n + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+            buffers.push_back({static_cast<i64>(offset), static_cast<i64>(n)});
+            return bytes.data() + offset;
+        }
+    };
+
+    /// Encode one column: validity bitmap and values.
+    /// A cell that can't be represented in the type fails the column (nothing is written as null instead).
+    bool encode(ipc::Type const type, std::string_view const name, Column const& column, Body& body, FieldNode& node) {
+        auto const n = column.size();
+        std::vector<u8> validity((n + 7) / 8);
+        i64 nulls{};
+        auto const set_null = [&](size_t const row) { validity[row >> 3] &= static_cast<u8>(~(1u << (row & 7))); ++nulls; };
+        std::ranges::fill(validity, 0xFF);
+        auto const mismatch = [&](size_t const row) {
+            logger::error("Arrow column '{}' can't represent the value of row {} (the type was chosen by the first batch).", name, row);
+            return false;
+        };
+
+        // INT64 and FLOAT64 - one 8-byte value per row, UTF8 and BINARY - offsets and bytes
+        auto const variable = type == ipc::UTF8 || type == ipc::BINARY;
+        std::vector<i64> numbers(variable ? 0 : n);
+        std::vector<i32> offsets{};
+        std::string bytes{};
+        if (variable) {
+            offsets.reserve(n + 1);
+            offsets.push_back(0);
+        }
+
+        for (size_t row = 0; row < n; ++row) {
+            auto const kind = column.kind(row);
+            if (kind == Value::MONOSTATE)
+                set_null(row);
+            else switch (type) {
+                case ipc::INT64:
+                    if (kind == Value::INTEGER)
+                        numbers[row] = column.integer(row);
+                    else if (kind == Value::DOUBLE && integral(column.real(row)))
+                        numbers[row] = static_cast<i64>(column.real(row));
+                    else
+                        return mismatch(row);
+                    break;
+                case ipc::FLOAT64:
+                    if (kind == Value::INTEGER && exact_double(column.integer(row)))
+                        numbers[row] = std::bit_cast<i64>(static_cast<f64>(column.integer(row)));
+                    else if (kind == Value::DOUBLE)
+                        numbers[row] = column.integer(row);     // the bits of the double
+                    else
+                        return mismatch(row);
+                    break;
+                case ipc::UTF8:
+                    if (kind == Value::STRING)
+                        bytes += column.text(row);
+                    else if (kind == Value::INTEGER)
+                        bytes += std::to_string(column.integer(row));
+                    else if (kind == Value::DOUBLE)
+                        bytes += std::format("{}", column.real(row));
+                    else
+                        return mismatch(row);
+                    break;
+                case ipc::BINARY:
+                    if (kind == Value::STRING)
+                        bytes += column.text(row);
+                    else if (kind == Value::VECTOR) {
+                        auto const blob = column.blob(row);
+                        bytes.append(reinterpret_cast<char const*>(blob.data()), blob.size());
+                    }
+                    else
+                        return mismatch(row);
+                    break;
+            }
+            if (variable) {
+                if (bytes.size() > static_cast<size_t>(std::numeric_limits<i32>::max())) {
+                    logger::error("Arrow batch is too big for 32-bit offsets, use fewer rows per batch.");
+                    return false;
+                }
+                offsets.push_back(static_cast<i32>(bytes.size()));
+            }
+        }
+
+        node = {static_cast<i64>(n), nulls};
+        if (nulls) {
+            auto const ptr = body.add(validity.size());
+            std::memcpy(ptr, validity.data(), validity.size());
+        }
+        else
+            body.add(0);
+        if (variable) {
+            std::memcpy(body.add(offsets.size() * sizeof(i32)), offsets.data(), offsets.size() * sizeof(i32));
+            std::memcpy(body.add(bytes.size()), bytes.data(), bytes.size());
+        }
+        else
+            std::memcpy(body.add(numbers.size() * sizeof(i64)), numbers.data(), numbers.size() * sizeof(i64));
+        return true;
+    }
+
+    /// The Message table with the header (the builder contains the header table).
+    std::vector<u8> message(Builder& b, u8 const header_type, u32 const header, i64 const body_length) {
+        b.start_table();
+        b.add(MESSAGE_BODY_LENGTH, body_length);
+        b.add_offset(MESSAGE_HEADER, header);
+        b.add(MESSAGE_VERSION, METADATA_V5);
+        b.add(MESSAGE_HEADER_TYPE, header_type);
+        return b.finish(b.end_table());
+    }
+}
+
+namespace ipc {
+    /********************************************************************
+    *                                                                   *
+    *                           W R I T E R                             *
+    *                                                                   *
+    ********************************************************************/
+
+    auto ArrowWriter::
+    write(ColumnarResult const& batch)
+    -> bool {
+        if (failed_ || finished_)
+            return false;
+        metrics::Timer const timer{metrics::SERIALIZE};
+
+        if (!schema_) {
+            for (size_t i = 0; i < batch.schema().size(); ++i)
+                types_.push_back(choose_type(batch.schema().declared_type(i), batch.column(i)));
+            schema_ = batch.shared_schema();
+            if (!write_schema(*schema_))
+                return false;
+        }
+        else if (batch.schema().size() != types_.size()) {
+            logger::error("Arrow batch has {} columns, the stream has {}.", batch.schema().size(), types_.size());
+            failed_ = true;
+            return false;
+        }
+        if (batch.empty())
+            return true;
+
+        Body body{};
+        std::vector<FieldNode> nodes(types_.size());
+        for (size_t i = 0; i < types_.size(); ++i)
+            if (!encode(types_[i], batch.schema().name(i), batch.column(i), body, nodes[i])) {
+                failed_ = true;
+                return false;
+            }
+
+        Builder b{};
+        auto const buffers = b.structs(std::span<Buffer const>{body.buffers});
+        auto const field_nodes = b.structs(std::span<FieldNode const>{nodes});
+        b.start_table();
+        b.add(RECORD_BATCH_LENGTH, static_cast<i64>(batch.size()));
+        b.add_offset(RECORD_BATCH_NODES, field_nodes);
+        b.add_offset(RECORD_BATCH_BUFFERS, buffers);
+        auto const header = b.end_table();
+        if (!write_message(message(b, HEADER_RECORD_BATCH, header, static_cast<i64>(body.bytes.size())), body.bytes))
+            return false;
+        rows_ += batch.size();
+        return true;
+    }
+
+    auto ArrowWriter::
+    finish()
+    -> bool {
+        if (failed_ || finished_)
+            return false;
+        if (!schema_) {
+            schema_ = std::make_shared<Schema const>();
+            if (!write_schema(*schema_))
+                return false;
+        }
+        finished_ = true;
+        std::array<char, 2 * sizeof(u32)> eos{};
+        std::memcpy(eos.data(), &CONTINUATION, sizeof(CONTINUATION));
+        if (!sink_(eos))
+            failed_ = true;
+        return !failed_;
+    }
+
+    auto ArrowWriter::
+    write_schema(Schema const& schema)
+    -> bool {
+        Builder b{};
+        std::vector<u32> fields{};
+        for (size_t i = 0; i < schema.size(); ++i) {
+            auto const name = b.string(schema.name(i));
+            auto const children = b.offsets({});
+            std::optional<u32> custom_metadata{};
+            if (auto const& declared = schema.declared_type(i); !declared.empty()) {
+                auto const key = b.string(DECLARED_TYPE_KEY);
+                auto const value = b.string(declared);
+                b.start_table();
+                b.add_offset(KEY_VALUE_KEY, key);
+                b.add_offset(KEY_VALUE_VALUE, value);
+                std::array const pairs{b.end_table()};
+                custom_metadata = b.offsets(pairs);
+            }
+
+            b.start_table();
+            u8 type_type{};
+            switch (types_[i]) {
+                case INT64:
+                    b.add<i32>(INT_BIT_WIDTH, 64);
+                    b.add<u8>(INT_IS_SIGNED, 1);
+                    type_type = TYPE_INT;
+                    break;
+                case FLOAT64:
+                    b.add(FLOATING_POINT_PRECISION, PRECISION_DOUBLE);
+                    type_type = TYPE_FLOATING_POINT;
+                    break;
+                case UTF8:
+                    type_type = TYPE_UTF8;
+                    break;
+                case BINARY:
+                    type_type = TYPE_BINARY;
+                    break;
+            }
+            auto const type = b.end_table();
+
+            b.start_table();
+            b.add_offset(FIELD_NAME, name);
+            b.add_offset(FIELD_TYPE, type);
+            b.add_offset(FIELD_CHILDREN, children);
+            if (custom_metadata)
+                b.add_offset(FIELD_CUSTOM_METADATA, *custom_metadata);
+            b.add<u8>(FIELD_NULLABLE, 1);
+            b.add(FIELD_TYPE_TYPE, type_type);
+            fields.push_back(b.end_table());
+        }
+        auto const vector = b.offsets(fields);
+        b.start_table();
+        b.add_offset(SCHEMA_FIELDS, vector);
+        auto const header = b.end_table();
+        return write_message(message(b, HEADER_SCHEMA, header, 0), {});
+    }
+
+    auto ArrowWriter::
+    write_message(std::vector<u8> const& metadata, std::vector<char> const& body)
+    -> bool {
+        std::vector<char> head(2 * sizeof(u32) + metadata.size());
+        auto const length = static_cast<u32>(metadata.size());
+        std::memcpy(head.data(), &CONTINUATION, sizeof(CONTINUATION));
+        std::memcpy(head.data() + sizeof(u32), &length, sizeof(length));
+        std::memcpy(head.data() + 2 * sizeof(u32), metadata.data(), metadata.size());
+        if (!sink_(head) || (!body.empty() && !sink_(body))) {
+            failed_ = true;
+            return false;
+        }
+        metrics::add(metrics::BYTES_SERIALIZED, head.size() + body.size());
+        return true;
+    }
+
+    /********************************************************************
+    *                                                                   *
+    *                           R E A D E R                             *
+    *                                                                   *
+    ********************************************************************/
+
+    auto ArrowReader::
+    feed(std::span<const char> const bytes)
+    -> void {
+        // drop the consumed bytes before the buffer grows
+        if (pos_ > 0 && pos_ >= buffer_.size() / 2) {
+            buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(pos_));
+            pos_ = 0;
+        }
+        buffer_.insert(buffer_.end(), bytes.begin(), bytes.end());
+    }
+
+    auto ArrowReader::
+    next()
+    -> std::optional<ColumnarResult> {
+        while (!done_ && !failed_) {
+            std::span const data{reinterpret_cast<u8 const*>(buffer_.data()) + pos_, buffer_.size() - pos_};
+            if (data.size() < sizeof(u32))
+                return {};
+            // Streams written before Arrow 0.15 have no continuation marker.
+            size_t prefix = sizeof(u32);
+            auto length = load<u32>(data.data());
+            if (length == CONTINUATION) {
+                if (data.size() < 2 * sizeof(u32))
+                    return {};
+                length = load<u32>(data.data() + sizeof(u32));
+                prefix = 2 * sizeof(u32);
+            }
+            if (length == 0) {
+                pos_ += prefix;
+                done_ = true;
+                return {};
+            }
+            if (length > MAX_METADATA) {
+                fail("invalid length of metadata");
+                return {};
+            }
+            if (data.size() < prefix + length)
+                return {};
+
+            auto const metadata = data.subspan(prefix, length);
+            auto const message = Table::root(metadata);
+            if (!message) {
+                fail("invalid message");
+                return {};
+            }
+            auto const version = message->scalar<i16>(MESSAGE_VERSION, 0);
+            if (version != METADATA_V4 && version != METADATA_V5) {
+                fail(std::format("unsupported metadata version {}", version));
+                return {};
+            }
+            auto const body_length = message->scalar<i64>(MESSAGE_BODY_LENGTH, 0);
+            if (body_length < 0) {
+                fail("invalid body length");
+                return {};
+            }
+            if (data.size() - prefix - length < static_cast<u64>(body_length))
+                return {};
+            auto const body = data.subspan(prefix + length, static_cast<size_t>(body_length));
+            pos_ += prefix + length + body.size();
+
+            switch (auto const type = message->scalar<u8>(MESSAGE_HEADER_TYPE, 0)) {
+                case HEADER_SCHEMA:
+                    if (schema_) {
+                        fail("second schema message");
+                        return {};
+                    }
+                    if (!read_schema(metadata))
+                        return {};
+                    break;
+                case HEADER_RECORD_BATCH: {
+                    if (!schema_) {
+                        fail("record batch before the schema");
+                        return {};
+                    }
+                    auto batch = read_batch(metadata, body);
+                    if (batch)
+                        rows_ += batch->size();
+                    return batch;
+                }
+                default:
+                    fail(std::format("unsupported message type {}", type));
+                    return {};
+            }
+        }
+        return {};
+    }
+
+    auto ArrowReader::
+    read_schema(std::span<const u8> const metadata)
+    -> bool {
+        auto const header = Table::root(metadata)->table(MESSAGE_HEADER);
+        if (!header) {
+            fail("invalid schema");
+            return false;
+        }
+        if (header->scalar<i16>(SCHEMA_ENDIANNESS, 0) != 0) {
+            fail("big-endian data is not supported");
+            return false;
+        }
+        auto const fields = header->vector(SCHEMA_FIELDS, sizeof(u32));
+        if (!fields) {
+            fail("schema without fields");
+            return false;
+        }
+
+        Schema schema{};
+        for (u32 i = 0; i < fields->second; ++i) {
+            auto const field = header->element(fields->first, i);
+            if (!field) {
+                fail("invalid field");
+                return false;
+            }
+            auto const name = std::string{field->string(FIELD_NAME).value_or("")};
+            if (field->table(FIELD_DICTIONARY)) {
+                fail(std::format("dictionary-encoded field '{}' is not supported", name));
+                return false;
+            }
+
+            Field f{field->scalar<u8>(FIELD_TYPE_TYPE, 0)};
+            auto const type = field->table(FIELD_TYPE);
+            switch (f.type) {
+                case TYPE_NULL: case TYPE_BOOL:
+                case TYPE_BINARY: case TYPE_UTF8:
+                case TYPE_LARGE_BINARY: case TYPE_LARGE_UTF8:
+                    break;
+                case TYPE_INT:
+                    f.bit_width = type ? static_cast<u8>(type->scalar<i32>(INT_BIT_WIDTH, 0)) : 0;
+                    f.is_signed = type && type->scalar<u8>(INT_IS_SIGNED, 0);
+                    if (f.bit_width != 8 && f.bit_width != 16 && f.bit_width != 32 && f.bit_width != 64) {
+                        fail(std::format("invalid bit width of field '{}'", name));
+                        return false;
+                    }
+                    break;
+                case TYPE_FLOATING_POINT:
+                    switch (type ? type->scalar<i16>(FLOATING_POINT_PRECISION, 0) : 0) {
+                        case PRECISION_SINGLE: f.bit_width = 32; break;
+                        case PRECISION_DOUBLE: f.bit_width = 64; break;
+                        default:
+                            fail(std::format("half precision of field '{}' is not supported", name));
+                            return false;
+                    }
+                    break;
+                default:
+                    fail(std::format("type {} of field '{}' is not supported", f.type, name));
+                    return false;
+            }
+
+            std::string declared{};
+            if (auto const pairs = field->vector(FIELD_CUSTOM_METADATA, sizeof(u32)))
+                for (u32 j = 0; j < pairs->second; ++j)
+                    if (auto const pair = field->element(pairs->first, j); pair && pair->string(KEY_VALUE_KEY) == DECLARED_TYPE_KEY)
+                        declared = pair->string(KEY_VALUE_VALUE).value_or("");
+            schema.add(name, std::move(declared));
+            fields_.push_back(f);
+        }
+        schema_ = std::make_shared<Schema const>(std::move(schema));
+        return true;
+    }
+
+    auto ArrowReader::
+    read_batch(std::span<const u8> const metadata, std::span<const u8> const body)
+    -> std::optional<ColumnarResult> {
+        auto const header = Table::root(metadata)->table(MESSAGE_HEADER);
+        if (!header) {
+            fail("invalid record batch");
+            return {};
+        }
+        if (header->table(RECORD_BATCH_COMPRESSION)) {
+            fail("compressed record batches are not supported");
+            return {};
+        }
+        auto const length = header->scalar<i64>(RECORD_BATCH_LENGTH, 0);
+        auto const nodes = header->vector(RECORD_BATCH_NODES, sizeof(FieldNode));
+        auto const buffers = header->vector(RECORD_BATCH_BUFFERS, sizeof(Buffer));
+        if (length < 0 || !nodes || !buffers || nodes->second != fields_.size()) {
+            fail("invalid record batch");
+            return {};
+        }
+        auto const n = static_cast<size_t>(length);
+
+        u32 next_buffer{};
+        // The next buffer of the body (std::nullopt if it is missing or out of the body).
+        auto const buffer = [&]() -> std::optional<std::span<const u8>> {
+            if (next_buffer == buffers->second)
+                return {};
+            auto const b = header->item<Buffer>(buffers->first, next_buffer++);
+            if (b.offset < 0 || b.length < 0 || static_cast<u64>(b.offset) + static_cast<u64>(b.length) > body.size())
+                return {};
+            return body.subspan(static_cast<size_t>(b.offset), static_cast<size_t>(b.length));
+        };
+
+        std::vector<Column> columns(fields_.size());
+        for (size_t i = 0; i < fields_.size(); ++i) {
+            auto const& field = fields_[i];
+            auto& column = columns[i];
+            auto const node = header->item<FieldNode>(nodes->first, i);
+            auto const broken = [&] {
+                fail(std::format("invalid data of field '{}'", schema_->name(i)));
+                return std::optional<ColumnarResult>{};
+            };
+            if (node.length != length || node.null_count < 0)
+                return broken();
+            if (field.type == TYPE_NULL) {
+                for (size_t row = 0; row < n; ++row)
+                    column.push_null();
+                continue;
+            }
+
+            auto const validity = buffer();
+            if (!validity || (node.null_count > 0 && validity->size() < (n + 7) / 8))
+                return broken();
+            auto const valid = [&](size_t const row) {
+                return node.null_count == 0 || ((*validity)[row >> 3] >> (row & 7)) & 1;
+            };
+
+            switch (field.type) {
+                case TYPE_BOOL: {
+                    auto const data = buffer();
+                    if (!data || data->size() < (n + 7) / 8)
+                        return broken();
+                    column.reserve(n);
+                    for (size_t row = 0; row < n; ++row)
+                        valid(row) ? column.push(i64{((*data)[row >> 3] >> (row & 7)) & 1}) : column.push_null();
+                    break;
+                }
+                case TYPE_INT: {
+                    auto const width = field.bit_width / 8;
+                    auto const data = buffer();
+                    if (!data || data->size() / width < n)
+                        return broken();
+                    column.reserve(n);
+                    auto const ptr = data->data();
+                    for (size_t row = 0; row < n; ++row) {
+                        if (!valid(row)) {
+                            column.push_null();
+                            continue;
+                        }
+                        auto const at = ptr + row * width;
+                        if (field.is_signed)
+                            switch (width) {
+                                case 1: column.push(i64{load<i8>(at)}); break;
+                                case 2: column.push(i64{load<i16>(at)}); break;
+                                case 4: column.push(i64{load<i32>(at)}); break;
+                                default: column.push(load<i64>(at));
+                            }
+                        else
+                            switch (width) {
+                                case 1: column.push(i64{load<u8>(at)}); break;
+                                case 2: column.push(i64{load<u16>(at)}); break;
+                                case 4: column.push(i64{load<u32>(at)}); break;
+                                default:
+                                    // like SQLite, integers beyond i64 are stored as REAL
+                                    if (auto const v = load<u64>(at); v > static_cast<u64>(std::numeric_limits<i64>::max()))
+                                        column.push(static_cast<f64>(v));
+                                    else
+                                        column.push(static_cast<i64>(v));
+                            }
+                    }
+                    break;
+                }
+                case TYPE_FLOATING_POINT: {
+                    auto const width = field.bit_width / 8;
+                    auto const data = buffer();
+                    if (!data || data->size() / width < n)
+                        return broken();
+                    column.reserve(n);
+                    for (size_t row = 0; row < n; ++row) {
+                        if (!valid(row))
+                            column.push_null();
+                        else if (width == 4)
+                            column.push(f64{load<float>(data->data() + row * width)});
+                        else
+                            column.push(load<f64>(data->data() + row * width));
+                    }
+                    break;
+                }
+                default: {
+                    // Utf8, Binary and their Large (64-bit offsets) variants
+                    auto const large = field.type == TYPE_LARGE_UTF8 || field.type == TYPE_LARGE_BINARY;
+                    auto const text = field.type == TYPE_UTF8 || field.type == TYPE_LARGE_UTF8;
+                    auto const width = large ? sizeof(i64) : sizeof(i32);
+                    auto const offsets = buffer();
+                    auto const data = buffer();
+                    if (!offsets || !data || (n > 0 && offsets->size() / width < n + 1))
+                        return broken();
+                    auto const offset = [&](size_t const row) {
+                        return large ? load<i64>(offsets->data() + row * width) : i64{load<i32>(offsets->data() + row * width)};
+                    };
+                    column.reserve(n);
+                    for (size_t row = 0; row < n; ++row) {
+                        if (!valid(row)) {
+                            column.push_null();
+                            continue;
+                        }
+                        auto const begin = offset(row);
+                        auto const end = offset(row + 1);
+                        if (begin < 0 || end < begin || static_cast<u64>(end) > data->size())
+                            return broken();
+                        auto const bytes = data->subspan(static_cast<size_t>(begin), static_cast<size_t>(end - begin));
+                        if (text)
+                            column.push_text({reinterpret_cast<char const*>(bytes.data()), bytes.size()});
+                        else
+                            column.push_blob(bytes);
+                    }
+                }
+            }
+        }
+
+        auto batch = ColumnarResult::from_columns(schema_, std::move(columns));
+        if (!batch)
+            fail("invalid record batch");
+        return batch;
+    }
+
+    auto ArrowReader::
+    fail(std::string_view const message)
+    -> void {
+        logger::error("Arrow stream: {}.", message);
+        failed_ = true;
+    }
+
+    /********************************************************************
+    *                                                                   *
+    *                           I M P O R T                             *
+    *                                                                   *
+    ********************************************************************/
+
+    auto ArrowImport::
+    exec(std::string const& table, std::span<const char> const bytes) const noexcept
+    -> std::optional<u64> {
+        try {
+            auto fed = false;
+            return exec(table, [&fed, bytes](ArrowReader& reader) {
+                if (fed)
+                    return false;
+                reader.feed(bytes);
+                fed = true;
+                return true;
+            });
+        }
+        catch (...) {
+            return {};
+        }
+    }
+
+    auto ArrowImport::
+    exec(std::string const& table, fs::path const& path) const noexcept
+    -> std::optional<u64> {
+        try {
+            std::ifstream file{path, std::ios::binary};
+            if (!file) {
+                logger::error("The file {} can't be opened.", path.string());
+                return {};
+            }
+            std::vector<char> chunk(1 << 20);
+            return exec(table, [&file, &chunk](ArrowReader& reader) {
+                file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                auto const n = file.gcount();
+                if (n <= 0)
+                    return false;
+                reader.feed({chunk.data(), static_cast<size_t>(n)});
+                return true;
+            });
+        }
+        catch (...) {
+            return {};
+        }
+    }
+
+    auto ArrowImport::
+    exec(std::string const& table, Feed const& feed) const
+    -> std::optional<u64> {
+        ArrowReader reader{};
+        auto const take = [&]() -> std::optional<ColumnarResult> {
+            for (;;) {
+                if (auto batch = reader.next())
+                    return batch;
+                if (reader.done() || reader.failed() || !feed(reader))
+                    return {};
+            }
+        };
+
+        auto batch = take();
+        if (reader.failed())
+            return {};
+        auto const schema = reader.schema();
+        if (!schema || schema->size() == 0) {
+            logger::error("The Arrow stream has no columns to import to {}.", table);
+            return {};
+        }
+
+        std::string names{};
+        std::string placeholders{};
+        for (auto const& name : schema->names()) {
+            if (!names.empty()) {
+                names += ',';
+                placeholders += ',';
+            }
+            names += shared::quote_identifier(name);
+            placeholders += '?';
+        }
+        auto const sql = std::format("INSERT INTO {} ({}) VALUES ({})", shared::quote_identifier(table), names, placeholders);
+
+        auto options = options_;
+        options.rowids = false;
+        u64 rows{};
+        size_t row{};
+        auto const inserted = BulkInsert(db_, cache_, stats_, options).exec(sql, [&](std::vector<Value>& values) {
+            while (batch && row == batch->size()) {
+                batch = take();
+                row = 0;
+            }
+            if (!batch)
+                return false;
+            for (size_t i = 0; i < schema->size(); ++i)
+                values.push_back(batch->column(i).value(row));
+            ++row;
+            ++rows;
+            return true;
+        });
+        if (!inserted)
+            return {};
+        if (reader.failed() || !reader.done()) {
+            logger::error("The Arrow stream is broken, {} rows were inserted to {}.", rows, table);
+            return {};
+        }
+        return rows;
+    }
+}
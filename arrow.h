@@ -0,0 +1,166 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include "columnar.h"
+#include "stream.h"
+#include "bulk.h"
+#include "stmt_cache.h"
+#include "transaction.h"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+
+/// Apache Arrow IPC streaming format (https://arrow.apache.org/docs/format/Columnar.html). \n
+/// The stream is a schema message, record batches and the end-of-stream marker. Every message is
+/// the continuation marker (0xFFFFFFFF), the length of the metadata, the metadata (flatbuffer
+/// Message padded to 8 bytes) and the body (buffers of the batch, each aligned to 8 bytes). \n
+/// Flatbuffers are built and read here, no Arrow (or flatbuffers) library is needed.
+namespace ipc {
+    /// Arrow type of an exported column.
+    enum Type : u8 {
+        INT64,      // Int(64, signed)
+        FLOAT64,    // FloatingPoint(DOUBLE)
+        UTF8,       // Utf8 (int32 offsets)
+        BINARY,     // Binary (int32 offsets)
+    };
+
+    /// Writer of the stream, batches are written to the sink as they come. \n
+    /// Types of columns are chosen when the first batch is written: the declared type of the column
+    /// (its SQLite affinity) if the values of the batch fit it, otherwise the values themselves
+    /// (integers only - INT64, numbers - FLOAT64, text - UTF8, blobs - BINARY). A cell of a later
+    /// batch that can't be represented in the chosen type (e.g. text in an INT64 column) fails
+    /// the export, nothing is written as null in its place.
+    class ArrowWriter {
+        StreamSink sink_;
+        std::shared_ptr<Schema const> schema_{};
+        std::vector<Type> types_{};
+        u64 rows_{};
+        bool finished_{};
+        bool failed_{};
+    public:
+        explicit ArrowWriter(StreamSink sink) : sink_{std::move(sink)} {}
+        /// No Copy
+        ArrowWriter(ArrowWriter const&) = delete;
+        ArrowWriter& operator=(ArrowWriter const&) = delete;
+
+        /// Write the batch (the first one writes the schema too).
+        /// All batches must have the same columns.
+        bool write(ColumnarResult const& batch);
+        /// Write the end-of-stream marker (and the schema if nothing was written).
+        bool finish();
+
+        [[nodiscard]] bool failed() const noexcept {
+            return failed_;
+        }
+        /// Number of rows written so far.
+        [[nodiscard]] u64 rows() const noexcept {
+            return rows_;
+        }
+        /// Types of columns (empty before the first batch).
+        [[nodiscard]] std::vector<Type> const& types() const noexcept {
+            return types_;
+        }
+
+    private:
+        bool write_schema(Schema const& schema);
+        bool write_message(std::vector<u8> const& metadata, std::vector<char> const& body);
+    };
+
+    /// Incremental reader of the stream. Feed it with bytes as they arrive and take the batches. \n
+    /// Supported types: Null, Bool, Int (8-64 bits, signed and unsigned), FloatingPoint (SINGLE, DOUBLE),
+    /// Utf8, Binary, LargeUtf8 and LargeBinary. Dictionaries and compressed bodies are not supported.
+    class ArrowReader {
+        struct Field {
+            u8 type{};          // Arrow Type union id
+            u8 bit_width{};     // Int, FloatingPoint
+            bool is_signed{};   // Int
+        };
+        std::vector<char> buffer_{};
+        size_t pos_{};
+        std::shared_ptr<Schema const> schema_{};
+        std::vector<Field> fields_{};
+        u64 rows_{};
+        bool done_{};
+        bool failed_{};
+    public:
+        /// Append received bytes.
+        void feed(std::span<const char> bytes);
+        /// Decode the next record batch if it is complete (std::nullopt if more bytes are needed,
+        /// at the end of stream or on error).
+        std::optional<ColumnarResult> next();
+
+        /// Schema of the stream (nullptr until the schema message is read).
+        [[nodiscard]] std::shared_ptr<Schema const> schema() const noexcept {
+            return schema_;
+        }
+        /// The end-of-stream marker was read.
+        [[nodiscard]] bool done() const noexcept {
+            return done_;
+        }
+        [[nodiscard]] bool failed() const noexcept {
+            return failed_;
+        }
+        /// Number of rows decoded so far.
+        [[nodiscard]] u64 rows() const noexcept {
+            return rows_;
+        }
+
+    private:
+        bool read_schema(std::span<const u8> metadata);
+        std::optional<ColumnarResult> read_batch(std::span<const u8> metadata, std::span<const u8> body);
+        void fail(std::string_view message);
+    };
+
+    /// Inserting record batches of the stream to the table with BulkInsert
+    /// (table columns are the fields of the stream, matched by name). \n
+    /// Rows are inserted while the stream is read. If the stream is broken, the rows inserted
+    /// before the error stay in the table (a transaction opened by the caller makes it all-or-nothing).
+    class ArrowImport {
+        sqlite3* db_{};
+        StmtCache* cache_{};
+        TransactionStats* stats_{};
+        BulkOptions options_{};
+    public:
+        ArrowImport(sqlite3* db, StmtCache* cache, TransactionStats* stats, BulkOptions const& options)
+            : db_{db}, cache_{cache}, stats_{stats}, options_{options} {}
+
+        /// Import the stream from memory. Returns the number of inserted rows.
+        std::optional<u64> exec(std::string const& table, std::span<const char> bytes) const noexcept;
+        /// Import the stream from the file (read in chunks). Returns the number of inserted rows.
+        std::optional<u64> exec(std::string const& table, fs::path const& path) const noexcept;
+
+    private:
+        /// Appends the next bytes of the stream to the reader, returns false at the end of the input.
+        using Feed = std::function<bool(ArrowReader&)>;
+        std::optional<u64> exec(std::string const& table, Feed const& feed) const;
+    };
+}
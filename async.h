@@ -0,0 +1,76 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "executor.h"
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+
+/// Awaitable running the work on the executor of a connection. \n
+/// The awaiting coroutine is suspended, the work is posted to 'worker' and,
+/// when it is done, the coroutine is resumed on the 'resume' executor
+/// (or directly on the worker thread if there is none).
+template<typename T>
+class Awaitable {
+    std::shared_ptr<Executor> worker_;
+    std::shared_ptr<Executor> resume_;
+    std::function<T()> work_;
+    std::optional<T> result_{};
+    std::exception_ptr error_{};
+public:
+    Awaitable(std::shared_ptr<Executor> worker, std::shared_ptr<Executor> resume, std::function<T()> work)
+        : worker_{std::move(worker)}, resume_{std::move(resume)}, work_{std::move(work)} {}
+
+    [[nodiscard]] bool await_ready() const noexcept {
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<> const handle) {
+        // The awaitable lives in the coroutine frame until the coroutine is resumed.
+        worker_->post([this, handle] {
+            // An exception can't escape the executor thread,
+            // it is rethrown in the awaiting coroutine.
+            try {
+                result_.emplace(work_());
+            }
+            catch (...) {
+                error_ = std::current_exception();
+            }
+            if (resume_)
+                resume_->post([handle] { handle.resume(); });
+            else
+                handle.resume();
+        });
+    }
+    T await_resume() {
+        if (error_)
+            std::rethrow_exception(error_);
+        return std::move(*result_);
+    }
+};
@@ -0,0 +1,112 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "backup.h"
+#include "logger.h"
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+auto BackupProgress::
+fraction() const noexcept
+-> double {
+    if (pages_total <= 0)
+        return 1.0;
+    return static_cast<double>(pages_copied()) / pages_total;
+}
+
+auto Backup::
+exec() const noexcept
+-> std::optional<BackupProgress> {
+    using Clock = std::chrono::steady_clock;
+    try {
+        // The guard finishes the backup if the progress callback throws.
+        std::unique_ptr<sqlite3_backup, decltype(&sqlite3_backup_finish)> backup{
+            sqlite3_backup_init(destination_, options_.destination_schema.c_str(), source_, options_.source_schema.c_str()),
+            sqlite3_backup_finish};
+        if (!backup) {
+            // the error is set on the destination connection
+            LOG_ERROR(destination_);
+            return {};
+        }
+
+        auto const start = Clock::now();
+        auto busy_since = std::optional<Clock::time_point>{};
+        BackupProgress progress{};
+        auto cancelled = false;
+        auto timed_out = false;
+        for (;;) {
+            auto const rc = sqlite3_backup_step(backup.get(), options_.pages_per_step);
+            progress.pages_total = sqlite3_backup_pagecount(backup.get());
+            progress.pages_remaining = sqlite3_backup_remaining(backup.get());
+            progress.elapsed = Clock::now() - start;
+            if (rc == SQLITE_DONE)
+                break;
+            if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+                auto const now = Clock::now();
+                if (!busy_since)
+                    busy_since = now;
+                else if (now - *busy_since > options_.busy_timeout) {
+                    timed_out = true;
+                    break;
+                }
+            }
+            else if (rc == SQLITE_OK)
+                busy_since.reset();
+            else
+                break;  // error, reported by sqlite3_backup_finish
+
+            if (options_.progress && !options_.progress(progress)) {
+                cancelled = true;
+                break;
+            }
+            // A busy database is retried after a pause even if no pause is set.
+            auto const pause = rc == SQLITE_OK ? options_.sleep : std::max(options_.sleep, std::chrono::milliseconds{1});
+            if (pause.count() > 0)
+                std::this_thread::sleep_for(pause);
+        }
+
+        if (SQLITE_OK != sqlite3_backup_finish(backup.release())) {
+            LOG_ERROR(destination_);
+            return {};
+        }
+        if (cancelled) {
+            logger::info("Backup was cancelled ({} of {} pages copied).", progress.pages_copied(), progress.pages_total);
+            return {};
+        }
+        if (timed_out) {
+            logger::error("Backup failed, the database was busy for longer than {} ms.", options_.busy_timeout.count());
+            return {};
+        }
+        if (options_.progress)
+            options_.progress(progress);
+        return progress;
+    }
+    catch (...) {
+        return {};
+    }
+}
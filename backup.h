@@ -0,0 +1,79 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <sqlite3.h>
+
+struct BackupProgress {
+    /// Pages of the source database (it may change while the source is written).
+    int pages_total{};
+    /// Pages still to be copied.
+    int pages_remaining{};
+    std::chrono::nanoseconds elapsed{};
+
+    [[nodiscard]] int pages_copied() const noexcept {
+        return pages_total - pages_remaining;
+    }
+    /// Copied part of the database, 0.0 ... 1.0.
+    [[nodiscard]] double fraction() const noexcept;
+};
+
+struct BackupOptions {
+    /// Pages copied in one step (negative - all pages in one step). The source is locked only
+    /// while a step runs, so writers of the source wait at most one step.
+    int pages_per_step{256};
+    /// Pause between steps, foreground queries of the source run in it.
+    std::chrono::milliseconds sleep{10};
+    /// Steps are retried while the source or destination is busy (locked), at most so long.
+    std::chrono::milliseconds busy_timeout{30'000};
+    /// Schemas of the copied database (e.g. an attached database).
+    std::string source_schema{"main"};
+    std::string destination_schema{"main"};
+    /// Called after every step (and once at the end); returns false to cancel the backup.
+    std::function<bool(BackupProgress const&)> progress{};
+};
+
+/// Online copy of a database page by page (sqlite3_backup_*). \n
+/// The source stays usable during the copy: it is read in steps of 'pages_per_step' pages.
+/// If another connection writes to the source between steps, SQLite restarts the copy
+/// (writes done through the source connection itself are copied as they happen).
+/// The destination is overwritten and locked for the whole copy.
+class Backup {
+    sqlite3* source_{};
+    sqlite3* destination_{};
+    BackupOptions options_{};
+public:
+    Backup(sqlite3* source, sqlite3* destination, BackupOptions options)
+        : source_{source}, destination_{destination}, options_{std::move(options)} {}
+
+    /// Copy the database. Returns the final progress (std::nullopt on error or cancellation).
+    std::optional<BackupProgress> exec() const noexcept;
+};
@@ -0,0 +1,158 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "data.h"
+#include "../stmt.h"
+
+/********************************************************************
+*                                                                   *
+*                           S E L E C T                             *
+*                                                                   *
+********************************************************************/
+
+static void BM_PointSelect(benchmark::State& state) {
+    auto const shape = bench::Shape::from(state);
+    auto const& db = bench::database(shape);
+    bench::Generator gen{};
+    for (auto _ : state) {
+        auto const id = static_cast<i64>(gen.next() % shape.rows) + 1;
+        auto result = db.select("SELECT * FROM t WHERE id=?", id);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PointSelect)->Apply(bench::shapes);
+
+/// Scan of 10% of rows.
+static void BM_RangeScan(benchmark::State& state) {
+    auto const shape = bench::Shape::from(state);
+    auto const& db = bench::database(shape);
+    auto const n = std::max<i64>(shape.rows / 10, 1);
+    bench::Generator gen{};
+    for (auto _ : state) {
+        auto const first = static_cast<i64>(gen.next() % (shape.rows - n + 1)) + 1;
+        auto result = db.select("SELECT * FROM t WHERE id BETWEEN ? AND ?", first, first + n - 1);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_RangeScan)->Apply(bench::shapes);
+
+/// Conversion of statement rows to Row (without the rest of select).
+/// Uses its own connection to get at the raw statement.
+static void BM_FetchRowData(benchmark::State& state) {
+    auto const shape = bench::Shape::from(state);
+    sqlite3* db{};
+    sqlite3_open(":memory:", &db);
+    sqlite3_exec(db, bench::create_table_sql(shape.width).c_str(), nullptr, nullptr, nullptr);
+    sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+    sqlite3_stmt* stmt{};
+    sqlite3_prepare_v2(db, bench::insert_sql(shape.width).c_str(), -1, &stmt, nullptr);
+    bench::Generator gen{};
+    for (i64 id = 1; id <= shape.rows; ++id) {
+        auto const values = bench::make_values(gen, id, shape);
+        bind2stmt(stmt, values);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+
+    sqlite3_prepare_v2(db, "SELECT * FROM t", -1, &stmt, nullptr);
+    auto const n = sqlite3_column_count(stmt);
+    for (auto _ : state) {
+        sqlite3_reset(stmt);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            auto row = fetch_row_data(stmt, n);
+            benchmark::DoNotOptimize(row);
+        }
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    state.SetItemsProcessed(state.iterations() * shape.rows);
+}
+BENCHMARK(BM_FetchRowData)->Apply(bench::shapes);
+
+/********************************************************************
+*                                                                   *
+*                           I N S E R T                             *
+*                                                                   *
+********************************************************************/
+
+static void BM_InsertSingle(benchmark::State& state) {
+    bench::Shape const shape{0, state.range(0), state.range(1)};
+    auto const& db = bench::database(shape, false);
+    auto const sql = bench::insert_sql(shape.width);
+    bench::Generator gen{};
+    i64 id = 0;
+    for (auto _ : state) {
+        auto const rowid = db.insert(Query{sql, bench::make_values(gen, ++id, shape)});
+        benchmark::DoNotOptimize(rowid);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InsertSingle)->ArgNames({"width", "value_size"})->ArgsProduct({bench::WIDTHS, bench::VALUE_SIZES});
+
+static void BM_InsertBulk(benchmark::State& state) {
+    auto const shape = bench::Shape::from(state);
+    auto const& db = bench::database(shape, false);
+    auto const sql = bench::insert_sql(shape.width);
+    bench::Generator gen{};
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::vector<std::vector<Value>> rows{};
+        rows.reserve(shape.rows);
+        for (i64 id = 1; id <= shape.rows; ++id)
+            rows.push_back(bench::make_values(gen, id, shape));
+        (void)db.exec("DELETE FROM t");
+        state.ResumeTiming();
+
+        auto ids = db.insert_many(sql, rows);
+        benchmark::DoNotOptimize(ids);
+    }
+    state.SetItemsProcessed(state.iterations() * shape.rows);
+}
+BENCHMARK(BM_InsertBulk)->Apply(bench::shapes);
+
+/********************************************************************
+*                                                                   *
+*                          P R E P A R E                            *
+*                                                                   *
+********************************************************************/
+
+/// Overhead of preparing the statement: Arg(0) - statement cache disabled, Arg(1) - enabled.
+static void BM_StmtPrepare(benchmark::State& state) {
+    auto const& db = bench::database({0, 4, 16}, false);
+    db.set_cache_capacity(state.range(0) ? StmtCache::DEFAULT_CAPACITY : 0);
+    for (auto _ : state) {
+        auto result = db.select("SELECT id, c0, c1, c2, c3 FROM t WHERE id=?", 1);
+        benchmark::DoNotOptimize(result);
+    }
+    db.set_cache_capacity(StmtCache::DEFAULT_CAPACITY);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StmtPrepare)->ArgName("cache")->Arg(0)->Arg(1);
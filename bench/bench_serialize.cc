@@ -0,0 +1,147 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "data.h"
+#include "../gzip.h"
+
+/********************************************************************
+*                                                                   *
+*                 T O   /   F R O M   B Y T E S                     *
+*                                                                   *
+********************************************************************/
+
+/// Arg: value size (bytes of text/blob).
+static void BM_ValueRoundTrip(benchmark::State& state) {
+    bench::Generator gen{};
+    std::vector<Value> values{};
+    for (size_t i = 0; i < 4; ++i)
+        values.push_back(gen.value(i, state.range(0)));
+    size_t nbytes = 0;
+    for (auto _ : state) {
+        for (auto const& v : values) {
+            auto const bytes = v.to_bytes();
+            auto value = Value::from_bytes(bytes);
+            benchmark::DoNotOptimize(value);
+            nbytes += bytes.size();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * values.size());
+    state.SetBytesProcessed(static_cast<i64>(nbytes));
+}
+BENCHMARK(BM_ValueRoundTrip)->ArgName("value_size")->Arg(16)->Arg(256)->Arg(4096);
+
+static void BM_FieldRoundTrip(benchmark::State& state) {
+    bench::Generator gen{};
+    Field const field{"column_name", gen.value(2, state.range(0))};
+    size_t nbytes = 0;
+    for (auto _ : state) {
+        auto const bytes = field.to_bytes();
+        auto f = Field::from_bytes(bytes);
+        benchmark::DoNotOptimize(f);
+        nbytes += bytes.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<i64>(nbytes));
+}
+BENCHMARK(BM_FieldRoundTrip)->ArgName("value_size")->Arg(16)->Arg(256)->Arg(4096);
+
+/// Args: width, value size.
+static void BM_RowRoundTrip(benchmark::State& state) {
+    bench::Generator gen{};
+    auto const row = bench::make_row(gen, 1, {1, state.range(0), state.range(1)});
+    size_t nbytes = 0;
+    for (auto _ : state) {
+        auto const bytes = row.to_bytes();
+        auto r = Row::from_bytes(bytes);
+        benchmark::DoNotOptimize(r);
+        nbytes += bytes.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<i64>(nbytes));
+}
+BENCHMARK(BM_RowRoundTrip)->ArgNames({"width", "value_size"})->ArgsProduct({{4, 16, 64}, bench::VALUE_SIZES});
+
+/// Args: rows, width, value size.
+static void BM_ResultRoundTrip(benchmark::State& state) {
+    auto const shape = bench::Shape::from(state);
+    auto const result = bench::make_result(shape);
+    size_t nbytes = 0;
+    for (auto _ : state) {
+        auto const bytes = result.to_bytes();
+        auto r = Result::from_bytes(bytes);
+        benchmark::DoNotOptimize(r);
+        nbytes += bytes.size();
+    }
+    state.SetItemsProcessed(state.iterations() * shape.rows);
+    state.SetBytesProcessed(static_cast<i64>(nbytes));
+}
+BENCHMARK(BM_ResultRoundTrip)->Apply(bench::shapes);
+
+/// Args: number of arguments, value size.
+static void BM_QueryRoundTrip(benchmark::State& state) {
+    bench::Generator gen{};
+    Query const query{bench::insert_sql(state.range(0) - 1),
+                      bench::make_values(gen, 1, {1, state.range(0) - 1, state.range(1)})};
+    size_t nbytes = 0;
+    for (auto _ : state) {
+        auto bytes = query.to_bytes();
+        auto q = Query::from_bytes(bytes);
+        benchmark::DoNotOptimize(q);
+        nbytes += bytes.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<i64>(nbytes));
+}
+BENCHMARK(BM_QueryRoundTrip)->ArgNames({"args", "value_size"})->ArgsProduct({{4, 16, 64}, bench::VALUE_SIZES});
+
+/********************************************************************
+*                                                                   *
+*                             G Z I P                               *
+*                                                                   *
+********************************************************************/
+
+/// Args: rows, width, value size (of the serialized result).
+static void BM_GzipCompress(benchmark::State& state) {
+    auto const bytes = bench::make_result(bench::Shape::from(state)).to_bytes();
+    for (auto _ : state) {
+        auto compressed = gzip::compress(bytes);
+        benchmark::DoNotOptimize(compressed);
+    }
+    state.SetBytesProcessed(static_cast<i64>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_GzipCompress)->Apply(bench::shapes);
+
+static void BM_GzipDecompress(benchmark::State& state) {
+    auto const bytes = bench::make_result(bench::Shape::from(state)).to_bytes();
+    auto const compressed = gzip::compress(bytes);
+    for (auto _ : state) {
+        auto plain = gzip::decompress(compressed);
+        benchmark::DoNotOptimize(plain);
+    }
+    state.SetBytesProcessed(static_cast<i64>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_GzipDecompress)->Apply(bench::shapes);
@@ -0,0 +1,164 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "../sqlite.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+/// Deterministic data for benchmarks (the same seed gives the same data on every run).
+namespace bench {
+    /// splitmix64
+    class Generator {
+        u64 state_;
+    public:
+        explicit Generator(u64 const seed = 0x5eed) : state_{seed} {}
+
+        u64 next() noexcept {
+            u64 z = (state_ += 0x9e37'79b9'7f4a'7c15);
+            z = (z ^ (z >> 30)) * 0xbf58'476d'1ce4'e5b9;
+            z = (z ^ (z >> 27)) * 0x94d0'49bb'1331'11eb;
+            return z ^ (z >> 31);
+        }
+        i64 integer() noexcept {
+            return static_cast<i64>(next() >> 1);
+        }
+        f64 real() noexcept {
+            return static_cast<f64>(next() >> 11) / static_cast<f64>(1ull << 53);
+        }
+        std::string text(size_t const n) {
+            std::string s(n, ' ');
+            for (auto& c : s)
+                c = static_cast<char>('a' + next() % 26);
+            return s;
+        }
+        std::vector<u8> blob(size_t const n) {
+            std::vector<u8> v(n);
+            for (auto& b : v)
+                b = static_cast<u8>(next());
+            return v;
+        }
+        /// Columns cycle through integer, real, text and blob.
+        Value value(size_t const column, size_t const size) {
+            switch (column % 4) {
+                case 0:  return Value{integer()};
+                case 1:  return Value{real()};
+                case 2:  return Value{text(size)};
+                default: return Value{blob(size)};
+            }
+        }
+    };
+
+    /// Sizes benchmarked by default (edit to benchmark other shapes).
+    inline std::vector<i64> const ROWS{1'000, 10'000};
+    inline std::vector<i64> const WIDTHS{4, 16};
+    inline std::vector<i64> const VALUE_SIZES{16, 256};
+
+    /// Benchmark arguments {rows, width, value_size} for all default shapes.
+    inline void shapes(benchmark::internal::Benchmark* b) {
+        b->ArgNames({"rows", "width", "value_size"});
+        b->ArgsProduct({ROWS, WIDTHS, VALUE_SIZES});
+    }
+
+    /// Size of the data: number of rows, columns and bytes of text/blob values.
+    struct Shape {
+        i64 rows{1'000};
+        i64 width{4};
+        i64 value_size{16};
+
+        /// Arguments of the benchmark are {rows, width, value_size}.
+        static Shape from(benchmark::State const& state) {
+            return {state.range(0), state.range(1), state.range(2)};
+        }
+    };
+
+    inline std::string column_name(size_t const i) {
+        return "c" + std::to_string(i);
+    }
+
+    /// Table 't' with the integer primary key 'id' and 'width' columns.
+    inline std::string create_table_sql(size_t const width) {
+        std::string sql = "CREATE TABLE t(id INTEGER PRIMARY KEY";
+        for (size_t i = 0; i < width; ++i)
+            sql += ", " + column_name(i);
+        return sql + ")";
+    }
+    inline std::string insert_sql(size_t const width) {
+        std::string sql = "INSERT INTO t(id";
+        for (size_t i = 0; i < width; ++i)
+            sql += ", " + column_name(i);
+        sql += ") VALUES(?";
+        for (size_t i = 0; i < width; ++i)
+            sql += ", ?";
+        return sql + ")";
+    }
+
+    inline std::vector<Value> make_values(Generator& gen, i64 const id, Shape const& shape) {
+        std::vector<Value> values{};
+        values.reserve(shape.width + 1);
+        values.emplace_back(id);
+        for (i64 i = 0; i < shape.width; ++i)
+            values.push_back(gen.value(i, shape.value_size));
+        return values;
+    }
+
+    inline Row make_row(Generator& gen, i64 const id, Shape const& shape) {
+        Row row{"id", Value{id}};
+        for (i64 i = 0; i < shape.width; ++i)
+            row.add(column_name(i), gen.value(i, shape.value_size));
+        return row;
+    }
+
+    inline Result make_result(Shape const& shape, u64 const seed = 0x5eed) {
+        Generator gen{seed};
+        Result result{};
+        for (i64 id = 1; id <= shape.rows; ++id)
+            result.add(make_row(gen, id, shape));
+        return result;
+    }
+
+    /// Open a new in-memory database with the table 't' filled with 'shape.rows' rows.
+    inline SQLite& database(Shape const& shape, bool const fill = true) {
+        auto& db = SQLite::self();
+        db.close();
+        db.create(":memory:", [&shape](SQLite const& sqlite) {
+            return sqlite.exec(create_table_sql(shape.width));
+        });
+        if (fill) {
+            Generator gen{};
+            i64 id = 0;
+            (void)db.insert_many(insert_sql(shape.width), [&](std::vector<Value>& values) {
+                if (id == shape.rows)
+                    return false;
+                values = make_values(gen, ++id, shape);
+                return true;
+            });
+        }
+        return db;
+    }
+}
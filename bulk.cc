@@ -0,0 +1,218 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "bulk.h"
+#include "stmt.h"
+#include "logger.h"
+#include "metrics.h"
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include <limits>
+#include <utility>
+
+/// Upper limit of rows inserted by one multi-row statement.
+static constexpr size_t MAX_ROWS_PER_STATEMENT = 256;
+
+auto BulkInsert::
+exec(std::string const& sql, RowSource const& next) const noexcept
+-> std::optional<std::vector<i64>> {
+    auto const single = cache_->acquire(db_, sql);
+    if (!single)
+        return {};
+
+    // Prepare the multi-row statement when it is wanted and possible.
+    std::string multi_sql{};
+    sqlite3_stmt* multi{};
+    size_t k = options_.multi_row ? rows_per_statement(single) : 0;
+    if (k > 1) {
+        if (auto const query = multi_row_query(sql, k)) {
+            multi_sql = *query;
+            // Not every table accepts RETURNING rowid (e.g. WITHOUT ROWID tables),
+            // in that case rows are inserted one by one.
+            multi = cache_->acquire(db_, multi_sql, false);
+        }
+    }
+    if (!multi)
+        k = 1;
+
+    auto const params = sqlite3_bind_parameter_count(single);
+    auto const own_transaction = sqlite3_get_autocommit(db_) != 0;
+    auto const batch_size = options_.batch_size ? options_.batch_size : std::numeric_limits<size_t>::max();
+
+    std::vector<i64> rowids{};
+    auto ok = true;
+    auto aborted = false;
+    // The row source and the allocations can throw. The transaction guard
+    // of the current batch rolls it back while the exception unwinds.
+    try {
+        std::vector<std::vector<Value>> pending(k);
+        auto has_more = true;
+        size_t in_transaction = 0;
+
+        // Insert rows collected in 'pending' (from 0 to n).
+        auto const flush = [&](size_t const n) {
+            if (n == k && multi) {
+                auto idx = 0;
+                for (size_t r = 0; r < n; ++r)
+                    for (auto const& v : pending[r])
+                        if (!bind_at(multi, ++idx, v))
+                            return false;
+                int rc;
+                while (SQLITE_ROW == (rc = metrics::step(multi)))
+                    if (options_.rowids)
+                        rowids.push_back(sqlite3_column_int64(multi, 0));
+                sqlite3_reset(multi);
+                return rc == SQLITE_DONE;
+            }
+            for (size_t r = 0; r < n; ++r) {
+                if (!bind2stmt(single, pending[r]) || SQLITE_DONE != metrics::step(single))
+                    return false;
+                if (options_.rowids)
+                    rowids.push_back(sqlite3_last_insert_rowid(db_));
+                sqlite3_reset(single);
+            }
+            return true;
+        };
+
+        while (ok && has_more) {
+            auto transaction = own_transaction
+                ? Transaction::begin(db_, Transaction::Mode::IMMEDIATE, stats_)
+                : std::optional<Transaction>{};
+            ok = transaction || !own_transaction;
+            in_transaction = 0;
+            while (ok && in_transaction < batch_size) {
+                // Collect rows for one statement.
+                size_t n = 0;
+                while (n < k && in_transaction + n < batch_size) {
+                    pending[n].clear();
+                    if (!(has_more = next(pending[n])))
+                        break;
+                    if (std::cmp_not_equal(pending[n].size(), params)) {
+                        logger::error("The number of placeholders and arguments does not match ({}, {})", params, pending[n].size());
+                        ok = false;
+                        break;
+                    }
+                    ++n;
+                }
+                if (ok && n)
+                    ok = flush(n);
+                in_transaction += n;
+                if (!has_more)
+                    break;
+            }
+            // Without commit the batch is rolled back by the transaction guard.
+            if (ok && transaction)
+                ok = transaction->commit();
+        }
+    }
+    catch (Abort const&) {
+        aborted = true;
+        ok = false;
+    }
+    catch (std::exception const& e) {
+        logger::error("Bulk insert failed: {}", e.what());
+        ok = false;
+    }
+    catch (...) {
+        logger::error("Bulk insert failed: unknown exception");
+        ok = false;
+    }
+
+    if (!ok && !aborted)
+        LOG_ERROR(db_);
+    if (multi)
+        cache_->release(multi_sql, multi);
+    cache_->release(sql, single);
+    if (ok)
+        return rowids;
+    return {};
+}
+
+/********************************************************************
+*                                                                   *
+*                     M U L T I - R O W   Q U E R Y                 *
+*                                                                   *
+********************************************************************/
+
+auto BulkInsert::
+rows_per_statement(sqlite3_stmt* const stmt) const noexcept
+-> size_t {
+    auto const params = sqlite3_bind_parameter_count(stmt);
+    if (params == 0)
+        return 0;
+    // The values tuple is repeated as text, numbered (?1) and named (:a) placeholders
+    // would be shared by all rows. Only anonymous '?' placeholders have no name.
+    for (auto i = 1; i <= params; ++i)
+        if (sqlite3_bind_parameter_name(stmt, i))
+            return 0;
+    auto const max_params = sqlite3_limit(db_, SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+    return std::min(MAX_ROWS_PER_STATEMENT, static_cast<size_t>(max_params / params));
+}
+
+auto BulkInsert::
+multi_row_query(std::string const& sql, size_t const n)
+-> std::optional<std::string> {
+    // Only 'INSERT ... VALUES (...)' with nothing after the values can be extended.
+    std::string upper{};
+    upper.reserve(sql.size());
+    std::ranges::transform(sql, std::back_inserter(upper), [](unsigned char const c) {
+        return static_cast<char>(std::toupper(c));
+    });
+    if (!upper.starts_with("INSERT"))
+        return {};
+    auto const values_pos = upper.rfind("VALUES");
+    if (values_pos == std::string::npos)
+        return {};
+    auto const open = sql.find('(', values_pos);
+    if (open == std::string::npos)
+        return {};
+
+    // Find the closing parenthesis of the values tuple.
+    auto depth = 0;
+    auto close = open;
+    for (; close < sql.size(); ++close) {
+        if (sql[close] == '(') ++depth;
+        else if (sql[close] == ')' && --depth == 0) break;
+        else if (sql[close] == '\'' || sql[close] == '"') return {};
+    }
+    if (close == sql.size())
+        return {};
+    if (!std::ranges::all_of(sql.substr(close + 1), [](unsigned char const c) { return std::isspace(c) || c == ';'; }))
+        return {};
+
+    auto const tuple = sql.substr(open, close - open + 1);
+    std::string query{sql, 0, open};
+    query.reserve(open + n * (tuple.size() + 1) + 16);
+    query.append(tuple);
+    for (size_t i = 1; i < n; ++i) {
+        query.push_back(',');
+        query.append(tuple);
+    }
+    query.append(" RETURNING rowid");
+    return query;
+}
@@ -0,0 +1,80 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include "value.h"
+#include "stmt_cache.h"
+#include "transaction.h"
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+
+struct BulkOptions {
+    /// Number of rows inserted in one transaction (0 means all rows in one transaction).
+    size_t batch_size{10'000};
+    /// Insert several rows with one statement (INSERT ... VALUES (...),(...),...).
+    /// Used only for plain 'INSERT ... VALUES (...)' queries with anonymous '?' placeholders on rowid tables,
+    /// the rowids are then read with RETURNING, in the order SQLite reports them.
+    bool multi_row{false};
+    /// Collect rowids of inserted rows (without them the result is an empty vector).
+    bool rowids{true};
+};
+
+/// Source of rows for the bulk insert.
+/// Appends the arguments of the next row to the (empty) vector, returns false when there are no more rows.
+/// A source that can't deliver the rows throws, the rows of the current transaction are then rolled back
+/// (BulkInsert::Abort stops the insert without logging an error, e.g. when it was cancelled).
+using RowSource = std::function<bool(std::vector<Value>&)>;
+
+/// Inserting many rows with one prepared statement. \n
+/// The statement is prepared once, then for every row its arguments are bound,
+/// the statement is stepped and reset. Rows are inserted in transactions of 'batch_size' rows
+/// begun as IMMEDIATE (if a transaction is already open, it is used instead).
+class BulkInsert {
+    sqlite3* db_{};
+    StmtCache* cache_{};
+    TransactionStats* stats_{};
+    BulkOptions options_{};
+public:
+    /// Thrown by the row source to stop the insert quietly.
+    struct Abort {};
+
+    BulkInsert(sqlite3* db, StmtCache* cache, TransactionStats* stats, BulkOptions const& options)
+        : db_{db}, cache_{cache}, stats_{stats}, options_{options} {}
+
+    /// Insert all rows from the source. Returns rowids of the inserted rows.
+    std::optional<std::vector<i64>> exec(std::string const& sql, RowSource const& next) const noexcept;
+
+private:
+    /// Query inserting 'n' rows at once (or std::nullopt if the query can't be extended).
+    static std::optional<std::string> multi_row_query(std::string const& sql, size_t n);
+    /// Number of rows inserted by one multi-row statement (0 if the statement has named or numbered placeholders).
+    [[nodiscard]] size_t rows_per_statement(sqlite3_stmt* stmt) const noexcept;
+};
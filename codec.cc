@@ -0,0 +1,506 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "codec.h"
+#include "executor.h"
+#include "metrics.h"
+#include "reader.h"
+#include "writer.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <latch>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <zlib.h>
+#if defined(SQLITE_WITH_ZSTD)
+#include <zstd.h>
+#endif
+#if defined(SQLITE_WITH_LZ4)
+#include <lz4.h>
+#endif
+
+namespace codec {
+    namespace {
+        constexpr int GZIP_WINDOW_BITS{15 + 16};   // gzip wrapper
+        constexpr int GZIP_DEFAULT_LEVEL{Z_BEST_SPEED};
+
+        /****************************************************************
+        *                                                               *
+        *                           G Z I P                             *
+        *                                                               *
+        ****************************************************************/
+
+        /// Per thread deflate stream, reset for every call.
+        class Deflate {
+            z_stream stream_{};
+            int level_{};
+            bool ready_{};
+        public:
+            ~Deflate() {
+                if (ready_) deflateEnd(&stream_);
+            }
+            z_stream* get(int const level) noexcept {
+                if (ready_ && level_ == level)
+                    return deflateReset(&stream_) == Z_OK ? &stream_ : nullptr;
+                if (ready_)
+                    deflateEnd(&stream_);
+                stream_ = {};
+                ready_ = deflateInit2(&stream_, level, Z_DEFLATED, GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+                level_ = level;
+                return ready_ ? &stream_ : nullptr;
+            }
+        };
+
+        /// Per thread inflate stream, reset for every call.
+        class Inflate {
+            z_stream stream_{};
+            bool ready_{};
+        public:
+            ~Inflate() {
+                if (ready_) inflateEnd(&stream_);
+            }
+            z_stream* get() noexcept {
+                if (ready_)
+                    return inflateReset(&stream_) == Z_OK ? &stream_ : nullptr;
+                ready_ = inflateInit2(&stream_, GZIP_WINDOW_BITS) == Z_OK;
+                return ready_ ? &stream_ : nullptr;
+            }
+        };
+
+        auto gzip_compress(std::span<const char> const plain, int const level)
+        -> std::optional<std::vector<char>> {
+            thread_local Deflate deflate{};
+            auto const stream = deflate.get(level == DEFAULT_LEVEL ? GZIP_DEFAULT_LEVEL : level);
+            if (!stream || plain.size() > std::numeric_limits<uInt>::max())
+                return {};
+
+            std::vector<char> buffer(deflateBound(stream, plain.size()));
+            stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(plain.data()));
+            stream->avail_in = plain.size();
+            stream->next_out = reinterpret_cast<Bytef*>(buffer.data());
+            stream->avail_out = buffer.size();
+            if (::deflate(stream, Z_FINISH) != Z_STREAM_END)
+                return {};
+            buffer.resize(stream->total_out);
+            return buffer;
+        }
+
+        bool gzip_decompress(std::span<const char> const compressed, std::span<char> const out) {
+            thread_local Inflate inflate{};
+            auto const stream = inflate.get();
+            if (!stream || compressed.size() > std::numeric_limits<uInt>::max() || out.size() > std::numeric_limits<uInt>::max())
+                return false;
+
+            stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+            stream->avail_in = compressed.size();
+            stream->next_out = reinterpret_cast<Bytef*>(out.data());
+            stream->avail_out = out.size();
+            return ::inflate(stream, Z_FINISH) == Z_STREAM_END && stream->total_out == out.size();
+        }
+
+        /****************************************************************
+        *                                                               *
+        *                           Z S T D                             *
+        *                                                               *
+        ****************************************************************/
+
+#if defined(SQLITE_WITH_ZSTD)
+        auto zstd_compress(std::span<const char> const plain, int const level)
+        -> std::optional<std::vector<char>> {
+            thread_local std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> ctx{ZSTD_createCCtx(), &ZSTD_freeCCtx};
+            if (!ctx)
+                return {};
+            std::vector<char> buffer(ZSTD_compressBound(plain.size()));
+            auto const n = ZSTD_compressCCtx(ctx.get(), buffer.data(), buffer.size(), plain.data(), plain.size(),
+                                             level == DEFAULT_LEVEL ? ZSTD_CLEVEL_DEFAULT : level);
+            if (ZSTD_isError(n))
+                return {};
+            buffer.resize(n);
+            return buffer;
+        }
+
+        bool zstd_decompress(std::span<const char> const compressed, std::span<char> const out) {
+            thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> ctx{ZSTD_createDCtx(), &ZSTD_freeDCtx};
+            if (!ctx)
+                return false;
+            auto const n = ZSTD_decompressDCtx(ctx.get(), out.data(), out.size(), compressed.data(), compressed.size());
+            return !ZSTD_isError(n) && n == out.size();
+        }
+#endif
+
+        /****************************************************************
+        *                                                               *
+        *                            L Z 4                              *
+        *                                                               *
+        ****************************************************************/
+
+#if defined(SQLITE_WITH_LZ4)
+        auto lz4_compress(std::span<const char> const plain, int const level)
+        -> std::optional<std::vector<char>> {
+            thread_local std::vector<char> state(LZ4_sizeofState());
+            if (plain.size() > LZ4_MAX_INPUT_SIZE)
+                return {};
+            std::vector<char> buffer(LZ4_compressBound(static_cast<int>(plain.size())));
+            auto const n = LZ4_compress_fast_extState(state.data(), plain.data(), buffer.data(),
+                                                      static_cast<int>(plain.size()), static_cast<int>(buffer.size()),
+                                                      level == DEFAULT_LEVEL ? 1 : level);
+            if (n <= 0)
+                return {};
+            buffer.resize(n);
+            return buffer;
+        }
+
+        bool lz4_decompress(std::span<const char> const compressed, std::span<char> const out) {
+            if (compressed.size() > LZ4_MAX_INPUT_SIZE || out.size() > LZ4_MAX_INPUT_SIZE)
+                return false;
+            auto const n = LZ4_decompress_safe(compressed.data(), out.data(),
+                                               static_cast<int>(compressed.size()), static_cast<int>(out.size()));
+            return n >= 0 && static_cast<size_t>(n) == out.size();
+        }
+#endif
+
+        /// Long-lived workers of parallel_for (hardware concurrency - 1, the caller is one more),
+        /// so every worker keeps its thread_local codec contexts between calls.
+        auto workers()
+        -> std::vector<std::unique_ptr<ThreadExecutor>> const& {
+            static auto const pool = [] {
+                std::vector<std::unique_ptr<ThreadExecutor>> pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+                for (auto& worker : pool)
+                    worker = std::make_unique<ThreadExecutor>();
+                return pool;
+            }();
+            return pool;
+        }
+
+        /// Run 'fn(i)' for i in [0, n) on up to 'threads' threads (the calling one included).
+        /// Every thread uses its own (thread_local) codec context.
+        void parallel_for(size_t const n, uint threads, std::function<void(size_t)> const& fn) {
+            auto const& pool = workers();
+            if (threads == 0)
+                threads = pool.size() + 1;
+            auto const nthreads = std::min<size_t>({threads, n, pool.size() + 1});
+            std::atomic<size_t> next{0};
+            auto const worker = [&] {
+                for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;)
+                    fn(i);
+            };
+            if (nthreads <= 1) {
+                worker();
+                return;
+            }
+
+            // Concurrent calls start at different workers.
+            static std::atomic<size_t> first{0};
+            auto const start = first.fetch_add(nthreads - 1, std::memory_order_relaxed);
+            std::latch done{static_cast<std::ptrdiff_t>(nthreads - 1)};
+            std::exception_ptr error{};
+            std::mutex error_mutex{};
+            for (size_t i = 1; i < nthreads; ++i)
+                pool[(start + i) % pool.size()]->post([&] {
+                    try {
+                        worker();
+                    }
+                    catch (...) {
+                        std::lock_guard lock{error_mutex};
+                        error = std::current_exception();
+                    }
+                    done.count_down();
+                });
+            try {
+                worker();
+            }
+            catch (...) {
+                // The workers refer to this frame, they must be done before it unwinds.
+                done.wait();
+                throw;
+            }
+            done.wait();
+            if (error)
+                std::rethrow_exception(error);
+        }
+    }
+
+    /********************************************************************
+    *                                                                   *
+    *                            C O D E C                              *
+    *                                                                   *
+    ********************************************************************/
+
+    bool available(Id const id) noexcept {
+        switch (id) {
+            case GZIP:
+                return true;
+#if defined(SQLITE_WITH_ZSTD)
+            case ZSTD:
+                return true;
+#endif
+#if defined(SQLITE_WITH_LZ4)
+            case LZ4:
+                return true;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    auto compress(std::span<const char> const plain, Options const options)
+    -> std::optional<std::vector<char>> {
+        switch (options.id) {
+            case GZIP:
+                return gzip_compress(plain, options.level);
+#if defined(SQLITE_WITH_ZSTD)
+            case ZSTD:
+                return zstd_compress(plain, options.level);
+#endif
+#if defined(SQLITE_WITH_LZ4)
+            case LZ4:
+                return lz4_compress(plain, options.level);
+#endif
+            default:
+                return {};
+        }
+    }
+
+    bool plausible_size(Id const id, size_t const compressed_size, size_t const size) noexcept {
+        if (size > MAX_FRAME_SIZE)
+            return false;
+        // The best ratio the codec can reach: deflate 1032:1, lz4 255:1,
+        // zstd (RLE blocks, 4 bytes per 128 KiB) 32768:1.
+        size_t ratio{};
+        switch (id) {
+            case GZIP:
+                ratio = 1032;
+                break;
+            case LZ4:
+                ratio = 255;
+                break;
+            case ZSTD:
+                ratio = 32768;
+                break;
+            default:
+                return false;
+        }
+        // A small constant covers headers of tiny inputs.
+        return size <= compressed_size * ratio + 64;
+    }
+
+    auto decompress(Id const id, std::span<const char> const compressed, size_t const size)
+    -> std::optional<std::vector<char>> {
+        if (!plausible_size(id, compressed.size(), size))
+            return {};
+        std::vector<char> buffer(size);
+        if (decompress_into(id, compressed, buffer))
+            return buffer;
+        return {};
+    }
+
+    bool decompress_into(Id const id, std::span<const char> const compressed, std::span<char> const out) {
+        switch (id) {
+            case GZIP:
+                return gzip_decompress(compressed, out);
+#if defined(SQLITE_WITH_ZSTD)
+            case ZSTD:
+                return zstd_decompress(compressed, out);
+#endif
+#if defined(SQLITE_WITH_LZ4)
+            case LZ4:
+                return lz4_decompress(compressed, out);
+#endif
+            default:
+                return false;
+        }
+    }
+
+    auto gunzip(std::span<const char> const compressed)
+    -> std::optional<std::vector<char>> {
+        thread_local Inflate inflate{};
+        auto const stream = inflate.get();
+        if (!stream || compressed.size() > std::numeric_limits<uInt>::max())
+            return {};
+
+        // The size is not known, the output grows.
+        std::vector<char> buffer(std::max<size_t>(compressed.size() * 4, 1024));
+        stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+        stream->avail_in = compressed.size();
+        for (;;) {
+            stream->next_out = reinterpret_cast<Bytef*>(buffer.data() + stream->total_out);
+            stream->avail_out = buffer.size() - stream->total_out;
+            auto const rc = ::inflate(stream, Z_NO_FLUSH);
+            if (rc == Z_STREAM_END)
+                break;
+            if (rc != Z_OK && rc != Z_BUF_ERROR)
+                return {};
+            if (stream->avail_out != 0)
+                return {};      // truncated input
+            if (buffer.size() >= MAX_FRAME_SIZE)
+                return {};
+            buffer.resize(std::min(buffer.size() * 2, MAX_FRAME_SIZE));
+        }
+        buffer.resize(stream->total_out);
+        return buffer;
+    }
+
+    /********************************************************************
+    *                                                                   *
+    *                            F R A M E                              *
+    *                                                                   *
+    ********************************************************************/
+
+    auto compress_frame(std::span<const char> const frame, Options const options)
+    -> std::optional<std::vector<char>> {
+        if (frame.empty())
+            return {};
+        metrics::Timer const timer{metrics::COMPRESS};
+        auto const marker = static_cast<char>(0b1000'0000 | options.id << 5 | (frame.front() & 0b1'1111));
+
+        if (options.block_size == 0 || frame.size() <= options.block_size) {
+            auto const compressed = compress(frame, options);
+            if (!compressed)
+                return {};
+
+            std::vector<char> buffer(sizeof(char) + sizeof(u8)
+                                     + wire::varint_size(frame.size())
+                                     + wire::varint_size(compressed->size())
+                                     + compressed->size());
+            Writer w{buffer};
+            w.put(marker);
+            w.put(u8{0});     // flags
+            w.put_varint(frame.size());
+            w.put_varint(compressed->size());
+            w.put(compressed->data(), compressed->size());
+            metrics::add(metrics::BYTES_COMPRESSED, buffer.size());
+            return buffer;
+        }
+
+        // Multi-block: blocks are compressed in parallel.
+        auto const count = (frame.size() + options.block_size - 1) / options.block_size;
+        std::vector<std::optional<std::vector<char>>> blocks(count);
+        parallel_for(count, options.threads, [&](size_t const i) {
+            blocks[i] = compress(frame.subspan(i * options.block_size).first(std::min(options.block_size, frame.size() - i * options.block_size)), options);
+        });
+        if (!std::ranges::all_of(blocks, [](auto const& block) { return block.has_value(); }))
+            return {};
+
+        // block count, index and blocks
+        size_t payload_size = wire::varint_size(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto const raw = std::min(options.block_size, frame.size() - i * options.block_size);
+            payload_size += wire::varint_size(raw) + wire::varint_size(blocks[i]->size()) + blocks[i]->size();
+        }
+
+        std::vector<char> buffer(sizeof(char) + sizeof(u8)
+                                 + wire::varint_size(frame.size())
+                                 + wire::varint_size(payload_size)
+                                 + payload_size);
+        Writer w{buffer};
+        w.put(marker);
+        w.put(MULTI_BLOCK);
+        w.put_varint(frame.size());
+        w.put_varint(payload_size);
+        w.put_varint(count);
+        for (size_t i = 0; i < count; ++i) {
+            w.put_varint(std::min(options.block_size, frame.size() - i * options.block_size));
+            w.put_varint(blocks[i]->size());
+        }
+        for (auto const& block : blocks)
+            w.put(block->data(), block->size());
+        metrics::add(metrics::BYTES_COMPRESSED, buffer.size());
+        return buffer;
+    }
+
+    auto decompress_frame(std::span<const char> const span, uint const threads)
+    -> std::optional<std::pair<std::vector<char>,size_t>> {
+        metrics::Timer const timer{metrics::DECOMPRESS};
+        Reader r{span};
+        auto const marker = r.get();
+        if (!marker || !is_compressed(*marker) || codec_bits(*marker) == LEGACY_GZIP)
+            return {};
+        auto const flags = r.get<u8>();
+        auto const size = r.varint();
+        auto const nbytes = r.varint();
+        if (!flags || (*flags & ~MULTI_BLOCK) || !size || !nbytes)
+            return {};
+        auto const payload = r.bytes(*nbytes);
+        if (!payload)
+            return {};
+        auto const id = static_cast<Id>(codec_bits(*marker));
+        if (*size > MAX_FRAME_SIZE || !available(id))
+            return {};
+
+        if (!(*flags & MULTI_BLOCK)) {
+            auto frame = decompress(id, *payload, *size);
+            if (!frame)
+                return {};
+            return std::pair{std::move(*frame), r.consumed()};
+        }
+
+        // Multi-block: check the index, then decompress blocks in parallel into the output.
+        Reader p{*payload};
+        auto const count = p.varint();
+        if (!count || *count > p.left() / 2)
+            return {};
+        struct Block {
+            size_t offset;
+            size_t size;
+            size_t compressed_size;
+            std::span<const char> compressed;
+        };
+        std::vector<Block> blocks(*count);
+        size_t offset = 0;
+        for (auto& block : blocks) {
+            auto const raw = p.varint();
+            auto const compressed = p.varint();
+            if (!raw || !compressed || *raw > *size - offset || !plausible_size(id, *compressed, *raw))
+                return {};
+            block = {offset, *raw, *compressed, {}};
+            offset += *raw;
+        }
+        if (offset != *size)
+            return {};
+        for (auto& block : blocks) {
+            auto const data = p.bytes(block.compressed_size);
+            if (!data)
+                return {};
+            block.compressed = *data;
+        }
+
+        std::vector<char> frame(*size);
+        std::atomic<bool> ok{true};
+        parallel_for(blocks.size(), threads, [&](size_t const i) {
+            auto const& block = blocks[i];
+            if (!decompress_into(id, block.compressed, std::span{frame}.subspan(block.offset, block.size)))
+                ok = false;
+        });
+        if (!ok)
+            return {};
+        return std::pair{std::move(frame), r.consumed()};
+    }
+}
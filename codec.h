@@ -0,0 +1,101 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include <span>
+#include <vector>
+#include <optional>
+
+/// Compression of serialized frames. \n
+/// Compressed frame: marker, flags (u8), uncompressed size (varint), compressed size (varint), compressed data.
+/// The marker has bit 7 set, bits 5-6 hold the codec and bits 0-4 are taken from the marker
+/// of the compressed (complete) frame, e.g. 'T' or 'Q'. \n
+/// With the MULTI_BLOCK flag the compressed data is: number of blocks (varint), block index
+/// (uncompressed and compressed size of every block, varints) and independently compressed blocks,
+/// so blocks are compressed and decompressed in parallel. \n
+/// Codec bits 0b10 are the legacy gzip layout (uppercase marker | 0x80, u32 size, gzip data of the body),
+/// it is still decoded.
+namespace codec {
+    enum Id : u8 {
+        ZSTD = 0b00,
+        LZ4 = 0b01,
+        GZIP = 0b11,
+    };
+    constexpr u8 LEGACY_GZIP{0b10};
+    /// Use the default level of the codec.
+    constexpr int DEFAULT_LEVEL{-1};
+
+    /// Flags of the compressed frame.
+    constexpr u8 MULTI_BLOCK{0b0000'0001};
+
+    /// Upper limit of the uncompressed size declared by a frame (the size is untrusted input).
+    constexpr size_t MAX_FRAME_SIZE{size_t{1} << 32};
+
+    /// gzip and zstd: compression level, lz4: acceleration (higher is faster).
+    struct Options {
+        Id id{GZIP};
+        int level{DEFAULT_LEVEL};
+        /// Frames bigger than the block size are split into blocks compressed in parallel (0 - never).
+        size_t block_size{0};
+        /// Number of threads compressing blocks (0 - hardware concurrency). \n
+        /// Blocks run on the caller and a shared pool of long-lived workers,
+        /// so at most hardware concurrency threads are used.
+        uint threads{0};
+    };
+
+    /// Check if the codec was compiled in (zstd and lz4 are optional, see CMakeLists.txt).
+    bool available(Id id) noexcept;
+
+    /// Compress the data with the codec (the thread's context of the codec is reused).
+    auto compress(std::span<const char> plain, Options options = {}) -> std::optional<std::vector<char>>;
+    /// Check if the data of 'compressed_size' bytes can decompress to 'size' bytes
+    /// (not above MAX_FRAME_SIZE and the maximal compression ratio of the codec).
+    bool plausible_size(Id id, size_t compressed_size, size_t size) noexcept;
+    /// Decompress the data of known uncompressed size (the output is allocated once).
+    /// std::nullopt if the size is not plausible for the compressed data.
+    auto decompress(Id id, std::span<const char> compressed, size_t size) -> std::optional<std::vector<char>>;
+    /// Decompress the data into the output which has exactly the uncompressed size.
+    bool decompress_into(Id id, std::span<const char> compressed, std::span<char> out);
+    /// Decompress gzip data of unknown size (legacy frames), up to MAX_FRAME_SIZE bytes.
+    auto gunzip(std::span<const char> compressed) -> std::optional<std::vector<char>>;
+
+    /// Check if the marker is the marker of compressed frame.
+    constexpr bool is_compressed(char const marker) noexcept {
+        return marker & 0b1000'0000;
+    }
+    /// Codec bits of the compressed frame marker.
+    constexpr u8 codec_bits(char const marker) noexcept {
+        return (static_cast<u8>(marker) >> 5) & 0b11;
+    }
+
+    /// Compress the complete frame (e.g. Result::to_bytes()) into the compressed frame.
+    auto compress_frame(std::span<const char> frame, Options options = {}) -> std::optional<std::vector<char>>;
+    /// Decompress the compressed frame (not legacy), returns the inner frame and the number of consumed bytes.
+    /// Blocks of multi-block frames are decompressed in parallel ('threads', 0 - hardware concurrency).
+    auto decompress_frame(std::span<const char> span, uint threads = 0) -> std::optional<std::pair<std::vector<char>,size_t>>;
+}
@@ -0,0 +1,699 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "columnar.h"
+#include "metrics.h"
+#include <algorithm>
+#include <set>
+#include <limits>
+#include <cstring>
+
+/********************************************************************
+*                                                                   *
+*                            S C H E M A                            *
+*                                                                   *
+********************************************************************/
+
+auto Schema::
+add(std::string name, std::string declared_type)
+-> Schema& {
+    index_.emplace(name, names_.size());
+    names_.push_back(std::move(name));
+    declared_types_.push_back(std::move(declared_type));
+    return *this;
+}
+
+auto Schema::
+index(std::string_view const name) const noexcept
+-> std::optional<size_t> {
+    if (auto const it = index_.find(name); it != index_.end())
+        return it->second;
+    return {};
+}
+
+/********************************************************************
+*                                                                   *
+*                            C O L U M N                            *
+*                                                                   *
+********************************************************************/
+
+auto Column::
+reserve(size_t const n)
+-> void {
+    kinds_.reserve(n);
+    numbers_.reserve(n);
+    offsets_.reserve(n + 1);
+}
+
+/// Replace the column of nulls only (as read from bytes) with the regular vectors.
+auto Column::
+expand()
+-> void {
+    if (nulls_) {
+        kinds_.assign(nulls_, Value::MONOSTATE);
+        numbers_.assign(nulls_, 0);
+        offsets_.assign(nulls_ + 1, 0);
+        nulls_ = 0;
+    }
+}
+
+auto Column::
+operator==(Column const& rhs) const
+-> bool {
+    if (nulls_ || rhs.nulls_) {
+        if (size() != rhs.size())
+            return false;
+        for (size_t row = 0; row < size(); ++row)
+            if (!is_null(row) || !rhs.is_null(row))
+                return false;
+        return true;
+    }
+    return kinds_ == rhs.kinds_ && numbers_ == rhs.numbers_ && offsets_ == rhs.offsets_ && bytes_ == rhs.bytes_;
+}
+
+auto Column::
+value(size_t const row) const
+-> Value {
+    switch (kind(row)) {
+        case Value::INTEGER:
+            return Value{integer(row)};
+        case Value::DOUBLE:
+            return Value{real(row)};
+        case Value::STRING:
+            return Value{std::string{text(row)}};
+        case Value::VECTOR: {
+            auto const data = blob(row);
+            return Value{std::vector<u8>{data.begin(), data.end()}};
+        }
+        default:
+            return {};
+    }
+}
+
+auto Column::
+push_null()
+-> Column& {
+    if (nulls_) {
+        ++nulls_;
+        return *this;
+    }
+    kinds_.push_back(Value::MONOSTATE);
+    numbers_.push_back(0);
+    offsets_.push_back(bytes_.size());
+    return *this;
+}
+
+auto Column::
+push(i64 const v)
+-> Column& {
+    expand();
+    kinds_.push_back(Value::INTEGER);
+    numbers_.push_back(v);
+    offsets_.push_back(bytes_.size());
+    return *this;
+}
+
+auto Column::
+push(f64 const v)
+-> Column& {
+    expand();
+    kinds_.push_back(Value::DOUBLE);
+    numbers_.push_back(std::bit_cast<i64>(v));
+    offsets_.push_back(bytes_.size());
+    return *this;
+}
+
+auto Column::
+push_text(std::string_view const v)
+-> Column& {
+    expand();
+    kinds_.push_back(Value::STRING);
+    numbers_.push_back(0);
+    bytes_.insert(bytes_.end(), v.begin(), v.end());
+    offsets_.push_back(bytes_.size());
+    return *this;
+}
+
+auto Column::
+push_blob(std::span<const u8> const v)
+-> Column& {
+    expand();
+    kinds_.push_back(Value::VECTOR);
+    numbers_.push_back(0);
+    bytes_.insert(bytes_.end(), v.begin(), v.end());
+    offsets_.push_back(bytes_.size());
+    return *this;
+}
+
+auto Column::
+push(Value const& v)
+-> Column& {
+    switch (v.kind()) {
+        case Value::INTEGER:
+            return push(v.value<i64>());
+        case Value::DOUBLE:
+            return push(v.value<f64>());
+        case Value::STRING:
+            return push_text(v.text());
+        case Value::VECTOR:
+            return push_blob(v.blob());
+        default:
+            return push_null();
+    }
+}
+
+/********************************************************************
+*                                                                   *
+*                  C O L U M N A R   R E S U L T                    *
+*                                                                   *
+********************************************************************/
+
+ColumnarResult::ColumnarResult(Schema schema)
+    : schema_{std::make_shared<Schema const>(std::move(schema))}
+    , columns_(schema_->size())
+{}
+
+ColumnarResult::ColumnarResult(std::shared_ptr<Schema const> schema)
+    : schema_{std::move(schema)}
+    , columns_(schema_->size())
+{}
+
+auto ColumnarResult::
+from_columns(std::shared_ptr<Schema const> schema, std::vector<Column> columns)
+-> std::optional<ColumnarResult> {
+    if (!schema || schema->size() != columns.size())
+        return {};
+    auto const rows = columns.empty() ? 0 : columns.front().size();
+    if (!std::ranges::all_of(columns, [rows](Column const& c) { return c.size() == rows; }))
+        return {};
+    ColumnarResult result{std::move(schema)};
+    result.columns_ = std::move(columns);
+    result.rows_ = rows;
+    return result;
+}
+
+auto ColumnarResult::
+reserve(size_t const n)
+-> void {
+    for (auto& column : columns_)
+        column.reserve(n);
+}
+
+auto ColumnarResult::
+add(sqlite3_stmt* const stmt)
+-> ColumnarResult& {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        auto& column = columns_[i];
+        auto const idx = static_cast<int>(i);
+        switch (sqlite3_column_type(stmt, idx)) {
+            case SQLITE_INTEGER:
+                column.push(static_cast<i64>(sqlite3_column_int64(stmt, idx)));
+                break;
+            case SQLITE_FLOAT:
+                column.push(sqlite3_column_double(stmt, idx));
+                break;
+            case SQLITE_TEXT: {
+                auto const ptr = reinterpret_cast<char const*>(sqlite3_column_text(stmt, idx));
+                auto const size = sqlite3_column_bytes(stmt, idx);
+                column.push_text({ptr, static_cast<size_t>(size)});
+                break;
+            }
+            case SQLITE_BLOB: {
+                auto const ptr = static_cast<u8 const*>(sqlite3_column_blob(stmt, idx));
+                auto const size = sqlite3_column_bytes(stmt, idx);
+                column.push_blob({ptr, static_cast<size_t>(size)});
+                break;
+            }
+            default:
+                column.push_null();
+        }
+    }
+    ++rows_;
+    return *this;
+}
+
+auto ColumnarResult::
+add(Row const& row)
+-> ColumnarResult& {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (auto const field = row[schema_->name(i)])
+            columns_[i].push(field->value());
+        else
+            columns_[i].push_null();
+    }
+    ++rows_;
+    return *this;
+}
+
+auto ColumnarResult::
+to_result() const
+-> Result {
+    Result result{};
+    for (auto const row : *this)
+        result.add(row.to_row());
+    return result;
+}
+
+auto ColumnarResult::
+from_result(Result const& result)
+-> ColumnarResult {
+    // Rows are maps, so the column order is not known. Columns are sorted by names.
+    std::set<std::string> names{};
+    for (auto it = result.cbegin(); it != result.cend(); ++it)
+        for (auto f = it->cbegin(); f != it->cend(); ++f)
+            names.insert(f->first);
+
+    Schema schema{};
+    for (auto const& name : names)
+        schema.add(name);
+
+    ColumnarResult columnar{std::move(schema)};
+    columnar.reserve(result.size());
+    for (auto it = result.cbegin(); it != result.cend(); ++it)
+        columnar.add(*it);
+    return columnar;
+}
+
+auto ColumnarResult::RowRef::
+to_row() const
+-> Row {
+    Row row{};
+    for (size_t i = 0; i < size(); ++i)
+        row.add(result_->schema_->name(i), value(i));
+    return row;
+}
+
+/********************************************************************
+*                                                                   *
+*                   S E R I A L I Z A T I O N                       *
+*                                                                   *
+********************************************************************/
+
+// Frame: 'C', version (u8), body size (u64), body.
+// Body: rows (u64), columns (u32), names and declared types (u32 size + bytes),
+// then for every column: encoding (u8), flags (u8) and the segment.
+// Segments:
+//  'N' - all cells are null, nothing more,
+//  'I' - (null bitmap) + rows * i64,
+//  'D' - (null bitmap) + rows * f64,
+//  'S' - (null bitmap) + (rows + 1) offsets (u32 or u64) + bytes,
+//  'V' - like 'S' for blobs,
+//  'E' - text dictionary: (null bitmap) + entries (u32) + code width (u8)
+//        + (entries + 1) offsets (u32) + bytes + rows * code,
+//  'X' - mixed kinds: rows * kind (u8) + rows * i64 + (rows + 1) * u64 offsets + bytes.
+// Bit set in the null bitmap means the cell is not null.
+
+namespace {
+    constexpr char COLUMNAR_MARKER{'C'};
+    constexpr u8 COLUMNAR_VERSION{1};
+    constexpr u8 FLAG_NULLS{0b01};
+    constexpr u8 FLAG_WIDE{0b10};
+
+    size_t bitmap_size(size_t const rows) noexcept {
+        return (rows + 7) / 8;
+    }
+}
+
+struct ColumnCodec {
+    struct Plan {
+        char encoding{'N'};
+        u8 flags{};
+        std::vector<std::string_view> dictionary{};
+        std::vector<u32> codes{};
+        u8 code_width{};
+        size_t size{};
+    };
+
+    static auto plan(Column const& column, bool const dictionary)
+    -> Plan {
+        auto const rows = column.size();
+        Plan plan{};
+
+        uint kinds = 0;   // bit per kind
+        for (auto const kind : column.kinds_)
+            kinds |= 1u << kind;
+        bool const nulls = kinds & (1u << Value::MONOSTATE);
+        kinds &= ~(1u << Value::MONOSTATE);
+
+        size_t const bitmap = nulls ? bitmap_size(rows) : 0;
+        if (nulls)
+            plan.flags |= FLAG_NULLS;
+        plan.size = sizeof(char) + sizeof(u8);
+
+        switch (kinds) {
+            case 0:
+                plan.flags = 0;
+                return plan;
+            case 1u << Value::INTEGER:
+                plan.encoding = 'I';
+                plan.size += bitmap + rows * sizeof(i64);
+                return plan;
+            case 1u << Value::DOUBLE:
+                plan.encoding = 'D';
+                plan.size += bitmap + rows * sizeof(f64);
+                return plan;
+            case 1u << Value::STRING:
+            case 1u << Value::VECTOR: {
+                plan.encoding = kinds == 1u << Value::STRING ? 'S' : 'V';
+                bool const wide = column.bytes_.size() > std::numeric_limits<u32>::max();
+                if (wide)
+                    plan.flags |= FLAG_WIDE;
+                plan.size += bitmap + (rows + 1) * (wide ? sizeof(u64) : sizeof(u32)) + column.bytes_.size();
+                if (plan.encoding == 'S' && dictionary)
+                    try_dictionary(column, plan, bitmap);
+                return plan;
+            }
+            default:
+                plan.encoding = 'X';
+                plan.flags = 0;
+                plan.size += rows * (sizeof(u8) + sizeof(i64)) + (rows + 1) * sizeof(u64) + column.bytes_.size();
+                return plan;
+        }
+    }
+
+    /// Use the dictionary if the column has few distinct values and it makes the segment smaller.
+    static void try_dictionary(Column const& column, Plan& plan, size_t const bitmap) {
+        auto const rows = column.size();
+        std::unordered_map<std::string_view, u32> index{};
+        std::vector<std::string_view> dictionary{};
+        std::vector<u32> codes(rows, 0);
+        size_t dictionary_bytes = 0;
+
+        for (size_t row = 0; row < rows; ++row) {
+            if (column.is_null(row))
+                continue;
+            auto const text = column.text(row);
+            auto const [it, added] = index.try_emplace(text, dictionary.size());
+            if (added) {
+                // low-cardinality columns only
+                if (dictionary.size() + 1 > rows / 2)
+                    return;
+                dictionary.push_back(text);
+                dictionary_bytes += text.size();
+            }
+            codes[row] = it->second;
+        }
+
+        u8 const width = dictionary.size() <= 0x100 ? 1 : dictionary.size() <= 0x10000 ? 2 : 4;
+        size_t const size
+            = sizeof(char) + sizeof(u8) + bitmap
+            + sizeof(u32) + sizeof(u8)
+            + (dictionary.size() + 1) * sizeof(u32) + dictionary_bytes
+            + rows * width;
+        if (size >= plan.size || dictionary_bytes > std::numeric_limits<u32>::max())
+            return;
+
+        plan.encoding = 'E';
+        plan.flags &= FLAG_NULLS;
+        plan.dictionary = std::move(dictionary);
+        plan.codes = std::move(codes);
+        plan.code_width = width;
+        plan.size = size;
+    }
+
+    static void write(Column const& column, Plan const& plan, Writer& w) {
+        auto const rows = column.size();
+        w.put(plan.encoding);
+        w.put(plan.flags);
+
+        if (plan.flags & FLAG_NULLS) {
+            for (size_t i = 0; i < rows; i += 8) {
+                u8 bits = 0;
+                for (size_t j = i; j < std::min(rows, i + 8); ++j)
+                    if (column.kinds_[j] != Value::MONOSTATE)
+                        bits |= 1 << (j - i);
+                w.put(bits);
+            }
+        }
+
+        switch (plan.encoding) {
+            case 'I':
+            case 'D':
+                w.put(column.numbers_.data(), rows * sizeof(i64));
+                break;
+            case 'S':
+            case 'V':
+                if (plan.flags & FLAG_WIDE)
+                    w.put(column.offsets_.data(), column.offsets_.size() * sizeof(u64));
+                else
+                    for (auto const offset : column.offsets_)
+                        w.put(static_cast<u32>(offset));
+                w.put(column.bytes_.data(), column.bytes_.size());
+                break;
+            case 'E': {
+                w.put(static_cast<u32>(plan.dictionary.size()));
+                w.put(plan.code_width);
+                u32 offset = 0;
+                w.put(offset);
+                for (auto const text : plan.dictionary)
+                    w.put(offset += text.size());
+                for (auto const text : plan.dictionary)
+                    w.put(text.data(), text.size());
+                for (auto const code : plan.codes) {
+                    switch (plan.code_width) {
+                        case 1: w.put(static_cast<u8>(code)); break;
+                        case 2: w.put(static_cast<u16>(code)); break;
+                        default: w.put(code);
+                    }
+                }
+                break;
+            }
+            case 'X':
+                w.put(column.kinds_.data(), rows);
+                w.put(column.numbers_.data(), rows * sizeof(i64));
+                w.put(column.offsets_.data(), column.offsets_.size() * sizeof(u64));
+                w.put(column.bytes_.data(), column.bytes_.size());
+                break;
+            default:
+                break;
+        }
+    }
+
+    template<typename T>
+    static auto read_array(Reader& r, std::vector<T>& v, size_t const n) -> bool {
+        auto const data = r.bytes(n * sizeof(T));
+        if (!data)
+            return false;
+        v.resize(n);
+        std::memcpy(v.data(), data->data(), data->size());
+        return true;
+    }
+
+    static auto read(Reader& r, size_t const rows)
+    -> std::optional<Column> {
+        auto const encoding = r.get();
+        auto const flags = r.get<u8>();
+        if (!encoding || !flags)
+            return {};
+
+        // every encoding but 'N' takes at least one byte per row
+        if (*encoding != 'N' && rows > r.left())
+            return {};
+
+        Column column{};
+        uint kind = Value::MONOSTATE;
+        size_t needed = 0;   // the smallest segment for 'rows' (checked before allocating)
+        switch (*encoding) {
+            case 'N':
+                column.nulls_ = rows;
+                return column;
+            case 'I': kind = Value::INTEGER; needed = rows * sizeof(i64); break;
+            case 'D': kind = Value::DOUBLE; needed = rows * sizeof(f64); break;
+            case 'S': kind = Value::STRING; needed = (rows + 1) * sizeof(u32); break;
+            case 'E': kind = Value::STRING; needed = sizeof(u32) + sizeof(u8) + sizeof(u32) + rows; break;
+            case 'V': kind = Value::VECTOR; needed = (rows + 1) * sizeof(u32); break;
+            case 'X': needed = rows * (sizeof(u8) + sizeof(i64)) + (rows + 1) * sizeof(u64); break;
+            default:  return {};
+        }
+        if (*flags & FLAG_NULLS)
+            needed += bitmap_size(rows);
+        if (needed > r.left())
+            return {};
+
+        column.kinds_.assign(rows, Value::MONOSTATE);
+        column.numbers_.assign(rows, 0);
+        column.offsets_.assign(rows + 1, 0);
+
+        if (*flags & FLAG_NULLS) {
+            auto const bitmap = r.bytes(bitmap_size(rows));
+            if (!bitmap)
+                return {};
+            for (size_t row = 0; row < rows; ++row)
+                if ((*bitmap)[row / 8] & (1 << (row % 8)))
+                    column.kinds_[row] = kind;
+        }
+        else if (*encoding != 'X')
+            std::ranges::fill(column.kinds_, kind);
+
+        switch (*encoding) {
+            case 'I':
+            case 'D':
+                if (!read_array(r, column.numbers_, rows))
+                    return {};
+                break;
+            case 'S':
+            case 'V': {
+                if (*flags & FLAG_WIDE) {
+                    if (!read_array(r, column.offsets_, rows + 1))
+                        return {};
+                } else {
+                    std::vector<u32> offsets{};
+                    if (!read_array(r, offsets, rows + 1))
+                        return {};
+                    std::ranges::copy(offsets, column.offsets_.begin());
+                }
+                if (!valid_offsets(column.offsets_) || !read_array(r, column.bytes_, column.offsets_.back()))
+                    return {};
+                break;
+            }
+            case 'E': {
+                auto const entries = r.get<u32>();
+                auto const width = r.get<u8>();
+                if (!entries || !width || (*width != 1 && *width != 2 && *width != 4))
+                    return {};
+                std::vector<u32> offsets{};
+                std::vector<char> bytes{};
+                if (!read_array(r, offsets, size_t{*entries} + 1))
+                    return {};
+                if (!valid_offsets(offsets) || !read_array(r, bytes, offsets.back()))
+                    return {};
+                auto const codes = r.bytes(rows * *width);
+                if (!codes)
+                    return {};
+
+                for (size_t row = 0; row < rows; ++row) {
+                    if (column.kinds_[row] != Value::MONOSTATE) {
+                        u32 code = 0;
+                        std::memcpy(&code, codes->data() + row * *width, *width);
+                        if (code >= *entries)
+                            return {};
+                        column.bytes_.insert(column.bytes_.end(), bytes.begin() + offsets[code], bytes.begin() + offsets[code + 1]);
+                    }
+                    column.offsets_[row + 1] = column.bytes_.size();
+                }
+                break;
+            }
+            case 'X':
+                if (!read_array(r, column.kinds_, rows) || !read_array(r, column.numbers_, rows))
+                    return {};
+                if (!std::ranges::all_of(column.kinds_, [](auto const k) { return k <= Value::VECTOR; }))
+                    return {};
+                if (!read_array(r, column.offsets_, rows + 1))
+                    return {};
+                if (!valid_offsets(column.offsets_) || !read_array(r, column.bytes_, column.offsets_.back()))
+                    return {};
+                break;
+            default:
+                break;
+        }
+        return column;
+    }
+
+    template<typename T>
+    static auto valid_offsets(std::vector<T> const& offsets) noexcept -> bool {
+        return offsets.front() == 0 && std::ranges::is_sorted(offsets);
+    }
+};
+
+auto ColumnarResult::
+to_bytes(bool const dictionary) const
+-> std::vector<char> {
+    metrics::Timer const timer{metrics::SERIALIZE};
+    std::vector<ColumnCodec::Plan> plans{};
+    plans.reserve(columns_.size());
+
+    size_t body_size = sizeof(u64) + sizeof(u32);
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        body_size += sizeof(u32) + schema_->name(i).size() + sizeof(u32) + schema_->declared_type(i).size();
+        plans.push_back(ColumnCodec::plan(columns_[i], dictionary));
+        body_size += plans.back().size;
+    }
+
+    std::vector<char> buffer(sizeof(char) + sizeof(u8) + sizeof(u64) + body_size);
+    Writer w{buffer};
+    w.put(COLUMNAR_MARKER);
+    w.put(COLUMNAR_VERSION);
+    w.put(static_cast<u64>(body_size));
+    w.put(static_cast<u64>(rows_));
+    w.put(static_cast<u32>(columns_.size()));
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        auto const& name = schema_->name(i);
+        auto const& type = schema_->declared_type(i);
+        w.put(static_cast<u32>(name.size()));
+        w.put(name.data(), name.size());
+        w.put(static_cast<u32>(type.size()));
+        w.put(type.data(), type.size());
+    }
+    for (size_t i = 0; i < columns_.size(); ++i)
+        ColumnCodec::write(columns_[i], plans[i], w);
+    metrics::add(metrics::BYTES_SERIALIZED, buffer.size());
+    return buffer;
+}
+
+auto ColumnarResult::
+from_bytes(std::span<const char> const span)
+-> std::pair<ColumnarResult,size_t> {
+    Reader r{span};
+    if (r.get() != COLUMNAR_MARKER || r.get<u8>() != COLUMNAR_VERSION)
+        return {};
+    auto const body_size = r.get<u64>();
+    if (!body_size)
+        return {};
+    auto const body = r.bytes(*body_size);
+    if (!body)
+        return {};
+
+    Reader b{*body};
+    auto const rows = b.get<u64>();
+    auto const count = b.get<u32>();
+    // Every column takes at least 2 bytes. Rows are not limited by the body size
+    // (a column of nulls only takes no bytes per row), every other encoding
+    // is checked against the remaining bytes before its vectors are allocated.
+    if (!rows || !count || *count > b.left() || (*rows && !*count))
+        return {};
+
+    Schema schema{};
+    for (u32 i = 0; i < *count; ++i) {
+        auto const name_size = b.get<u32>();
+        auto const name = name_size ? b.bytes(*name_size) : std::nullopt;
+        auto const type_size = b.get<u32>();
+        auto const type = type_size ? b.bytes(*type_size) : std::nullopt;
+        if (!name || !type)
+            return {};
+        schema.add(std::string{name->begin(), name->end()}, std::string{type->begin(), type->end()});
+    }
+
+    ColumnarResult result{std::move(schema)};
+    for (auto& column : result.columns_) {
+        auto decoded = ColumnCodec::read(b, *rows);
+        if (!decoded)
+            return {};
+        column = std::move(*decoded);
+    }
+    result.rows_ = *rows;
+    return {std::move(result), r.consumed()};
+}
@@ -0,0 +1,281 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include "value.h"
+#include "result.h"
+#include "reader.h"
+#include "writer.h"
+#include <bit>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <sqlite3.h>
+
+/// Names, declared types and indexes of the result columns.
+/// One schema is shared by all rows of a ColumnarResult.
+class Schema {
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view const sv) const noexcept {
+            return std::hash<std::string_view>{}(sv);
+        }
+    };
+    std::vector<std::string> names_{};
+    std::vector<std::string> declared_types_{};
+    std::unordered_map<std::string, size_t, Hash, std::equal_to<>> index_{};
+public:
+    Schema() = default;
+
+    /// Add a column (the declared type is empty for expressions).
+    Schema& add(std::string name, std::string declared_type = {});
+
+    [[nodiscard]] size_t size() const noexcept {
+        return names_.size();
+    }
+    [[nodiscard]] std::string const& name(size_t const i) const {
+        return names_[i];
+    }
+    [[nodiscard]] std::string const& declared_type(size_t const i) const {
+        return declared_types_[i];
+    }
+    [[nodiscard]] std::vector<std::string> const& names() const noexcept {
+        return names_;
+    }
+    /// Resolve the column name to its position (done once, not for every cell).
+    [[nodiscard]] std::optional<size_t> index(std::string_view name) const noexcept;
+
+    bool operator==(Schema const& rhs) const {
+        return names_ == rhs.names_ && declared_types_ == rhs.declared_types_;
+    }
+};
+
+/// Cells of one column kept in contiguous vectors. \n
+/// Integers and doubles (as bits) share one 8-byte slot per row,
+/// text and blob bytes are stored one after another and located by offsets.
+class Column {
+    friend struct ColumnCodec;
+    std::vector<u8> kinds_{};       // Value::MONOSTATE ... Value::VECTOR
+    std::vector<i64> numbers_{};
+    std::vector<u64> offsets_{0};   // bytes of row 'i' are [offsets_[i], offsets_[i+1])
+    std::vector<char> bytes_{};
+    size_t nulls_{};                // rows of a column of nulls only, kept without the vectors
+public:
+    [[nodiscard]] size_t size() const noexcept {
+        return nulls_ ? nulls_ : kinds_.size();
+    }
+    void reserve(size_t n);
+
+    [[nodiscard]] uint kind(size_t const row) const noexcept {
+        return nulls_ ? Value::MONOSTATE : kinds_[row];
+    }
+    [[nodiscard]] bool is_null(size_t const row) const noexcept {
+        return nulls_ || kinds_[row] == Value::MONOSTATE;
+    }
+    /// Get integer value without checking.
+    [[nodiscard]] i64 integer(size_t const row) const noexcept {
+        return nulls_ ? 0 : numbers_[row];
+    }
+    /// Get floating point value without checking.
+    [[nodiscard]] f64 real(size_t const row) const noexcept {
+        return std::bit_cast<f64>(integer(row));
+    }
+    /// Get text without checking.
+    [[nodiscard]] std::string_view text(size_t const row) const noexcept {
+        if (nulls_)
+            return {};
+        return {bytes_.data() + offsets_[row], offsets_[row + 1] - offsets_[row]};
+    }
+    /// Get blob without checking.
+    [[nodiscard]] std::span<const u8> blob(size_t const row) const noexcept {
+        if (nulls_)
+            return {};
+        auto const ptr = reinterpret_cast<u8 const*>(bytes_.data());
+        return {ptr + offsets_[row], offsets_[row + 1] - offsets_[row]};
+    }
+    /// Copy the cell to the Value.
+    [[nodiscard]] Value value(size_t row) const;
+
+    Column& push_null();
+    Column& push(i64 v);
+    Column& push(f64 v);
+    Column& push_text(std::string_view v);
+    Column& push_blob(std::span<const u8> v);
+    Column& push(Value const& v);
+
+    bool operator==(Column const& rhs) const;
+private:
+    void expand();
+};
+
+/// Result stored column by column with one shared schema. \n
+/// Rows are only views (result + row number), cell access by column position does not hash.
+class ColumnarResult {
+    std::shared_ptr<Schema const> schema_{std::make_shared<Schema const>()};
+    std::vector<Column> columns_{};
+    size_t rows_{};
+public:
+    /// Lightweight view of one row.
+    class RowRef {
+        ColumnarResult const* result_{};
+        size_t row_{};
+    public:
+        RowRef() = default;
+        RowRef(ColumnarResult const* result, size_t const row) : result_{result}, row_{row} {}
+
+        [[nodiscard]] size_t index() const noexcept {
+            return row_;
+        }
+        [[nodiscard]] size_t size() const noexcept {
+            return result_->columns_.size();
+        }
+        [[nodiscard]] bool is_null(size_t const col) const noexcept {
+            return result_->columns_[col].is_null(row_);
+        }
+        [[nodiscard]] uint kind(size_t const col) const noexcept {
+            return result_->columns_[col].kind(row_);
+        }
+        [[nodiscard]] i64 integer(size_t const col) const noexcept {
+            return result_->columns_[col].integer(row_);
+        }
+        [[nodiscard]] f64 real(size_t const col) const noexcept {
+            return result_->columns_[col].real(row_);
+        }
+        [[nodiscard]] std::string_view text(size_t const col) const noexcept {
+            return result_->columns_[col].text(row_);
+        }
+        [[nodiscard]] std::span<const u8> blob(size_t const col) const noexcept {
+            return result_->columns_[col].blob(row_);
+        }
+        [[nodiscard]] Value value(size_t const col) const {
+            return result_->columns_[col].value(row_);
+        }
+        /// Access by name (hashes the name, prefer resolving the index once).
+        [[nodiscard]] std::optional<Value> operator[](std::string_view const name) const {
+            if (auto const col = result_->schema_->index(name))
+                return value(*col);
+            return {};
+        }
+        /// Create the classic (map based) row.
+        [[nodiscard]] Row to_row() const;
+    };
+
+    class iterator {
+        ColumnarResult const* result_{};
+        size_t row_{};
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = RowRef;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        iterator(ColumnarResult const* result, size_t const row) : result_{result}, row_{row} {}
+
+        RowRef operator*() const { return {result_, row_}; }
+        RowRef operator[](difference_type const n) const { return {result_, row_ + n}; }
+        iterator& operator++() { ++row_; return *this; }
+        iterator operator++(int) { auto tmp = *this; ++row_; return tmp; }
+        iterator& operator--() { --row_; return *this; }
+        iterator operator--(int) { auto tmp = *this; --row_; return tmp; }
+        iterator& operator+=(difference_type const n) { row_ += n; return *this; }
+        iterator& operator-=(difference_type const n) { row_ -= n; return *this; }
+        friend iterator operator+(iterator it, difference_type const n) { return it += n; }
+        friend iterator operator+(difference_type const n, iterator it) { return it += n; }
+        friend iterator operator-(iterator it, difference_type const n) { return it -= n; }
+        friend difference_type operator-(iterator const& a, iterator const& b) {
+            return static_cast<difference_type>(a.row_) - static_cast<difference_type>(b.row_);
+        }
+        friend bool operator==(iterator const& a, iterator const& b) { return a.row_ == b.row_; }
+        friend auto operator<=>(iterator const& a, iterator const& b) { return a.row_ <=> b.row_; }
+    };
+
+    ColumnarResult() = default;
+    explicit ColumnarResult(Schema schema);
+    /// Empty result with the schema shared with other results (e.g. batches of one query).
+    explicit ColumnarResult(std::shared_ptr<Schema const> schema);
+    /// Assemble the result from columns (std::nullopt if they don't match the schema or differ in size).
+    static std::optional<ColumnarResult> from_columns(std::shared_ptr<Schema const> schema, std::vector<Column> columns);
+
+    [[nodiscard]] auto empty() const noexcept {
+        return rows_ == 0;
+    }
+    [[nodiscard]] auto size() const noexcept {
+        return rows_;
+    }
+    [[nodiscard]] Schema const& schema() const noexcept {
+        return *schema_;
+    }
+    [[nodiscard]] std::shared_ptr<Schema const> shared_schema() const noexcept {
+        return schema_;
+    }
+    [[nodiscard]] Column const& column(size_t const i) const {
+        return columns_[i];
+    }
+    /// Resolve the column name once and use the index for all rows.
+    [[nodiscard]] std::optional<size_t> column_index(std::string_view const name) const noexcept {
+        return schema_->index(name);
+    }
+    RowRef operator[](size_t const row) const {
+        return {this, row};
+    }
+    void reserve(size_t n);
+
+    /// Append the current row of the statement.
+    ColumnarResult& add(sqlite3_stmt* stmt);
+    /// Append the row (its cells are matched to the columns by name).
+    ColumnarResult& add(Row const& row);
+
+    /// Conversion to and from the classic (map based) result.
+    [[nodiscard]] Result to_result() const;
+    static ColumnarResult from_result(Result const& result);
+
+    /// Column-oriented serialization: the schema once, then one segment per column
+    /// (null bitmap, packed i64/f64 array or offsets and bytes of text/blobs). \n
+    /// With 'dictionary' low-cardinality text columns are written as a dictionary and codes.
+    [[nodiscard]] std::vector<char> to_bytes(bool dictionary = true) const;
+    /// Deserialization. Returns the result and the number of consumed bytes (0 on error).
+    static std::pair<ColumnarResult,size_t> from_bytes(std::span<const char> span);
+
+    bool operator==(ColumnarResult const& rhs) const {
+        return rows_ == rhs.rows_ && *schema_ == *rhs.schema_ && columns_ == rhs.columns_;
+    }
+
+    /****************************************************************
+    *                                                               *
+    *                      I T E R A T O R S                        *
+    *                                                               *
+    ****************************************************************/
+
+    [[nodiscard]] iterator begin() const { return {this, 0}; }
+    [[nodiscard]] iterator end() const { return {this, rows_}; }
+};
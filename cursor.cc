@@ -0,0 +1,129 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "cursor.h"
+#include "stmt.h"
+#include "logger.h"
+#include "metrics.h"
+
+Cursor::~Cursor() {
+    close();
+}
+
+Cursor::Cursor(Cursor&& rhs) noexcept
+    : db_{rhs.db_}
+    , cache_{rhs.cache_}
+    , stmt_{std::exchange(rhs.stmt_, nullptr)}
+    , query_{std::move(rhs.query_)}
+    , column_count_{rhs.column_count_}
+    , row_{std::move(rhs.row_)}
+    , done_{rhs.done_}
+    , failed_{rhs.failed_}
+{}
+
+Cursor& Cursor::operator=(Cursor&& rhs) noexcept {
+    if (this != &rhs) {
+        close();
+        db_ = rhs.db_;
+        cache_ = rhs.cache_;
+        stmt_ = std::exchange(rhs.stmt_, nullptr);
+        query_ = std::move(rhs.query_);
+        column_count_ = rhs.column_count_;
+        row_ = std::move(rhs.row_);
+        done_ = rhs.done_;
+        failed_ = rhs.failed_;
+    }
+    return *this;
+}
+
+auto Cursor::
+open(sqlite3* const db, StmtCache* const cache, Query query) noexcept
+-> std::optional<Cursor> {
+    if (!query.valid())
+        return {};
+
+    // The query is stored in the cursor,
+    // because its arguments are needed as long as the statement is stepped.
+    Cursor cursor{db, cache, std::move(query)};
+    auto const& sql = cursor.query_.cmd();
+    if (cache)
+        cursor.stmt_ = cache->acquire(db, sql);
+    else if (SQLITE_OK != metrics::prepare(db, sql, 0, &cursor.stmt_))
+        cursor.stmt_ = nullptr;
+
+    if (cursor.stmt_) {
+        if (bind2stmt(cursor.stmt_, cursor.query_.values())) {
+            cursor.column_count_ = sqlite3_column_count(cursor.stmt_);
+            return cursor;
+        }
+    }
+    LOG_ERROR(db);
+    return {};
+}
+
+auto Cursor::
+next()
+-> std::optional<Row> {
+    step();
+    return std::move(row_);
+}
+
+auto Cursor::
+step()
+-> void {
+    row_.reset();
+    if (done_ || !stmt_)
+        return;
+
+    switch (metrics::step(stmt_)) {
+        case SQLITE_ROW:
+            row_ = fetch_row_data(stmt_, column_count_);
+            return;
+        case SQLITE_DONE:
+            done_ = true;
+            break;
+        default:
+            failed_ = done_ = true;
+            LOG_ERROR(db_);
+    }
+    // There is nothing more to read, the statement is no longer needed.
+    close();
+}
+
+auto Cursor::
+close() noexcept
+-> void {
+    if (!stmt_)
+        return;
+
+    // The cache resets the statement after a failed step too, it stays usable.
+    if (cache_)
+        cache_->release(query_.cmd(), stmt_);
+    else if (SQLITE_OK != metrics::finalize(stmt_) && !failed_)
+        LOG_ERROR(db_);
+    stmt_ = nullptr;
+}
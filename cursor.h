@@ -0,0 +1,123 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include "query.h"
+#include "row.h"
+#include "stmt_cache.h"
+#include <iterator>
+#include <optional>
+#include <sqlite3.h>
+
+/// Lazy result of a SELECT query. \n
+/// Every row is fetched from the database only when the iteration reaches it,
+/// so the memory used does not depend on the size of the result.
+/// The cursor is a single-pass (input) range, usable in range-for and with range views.
+class Cursor {
+    sqlite3* db_{};
+    StmtCache* cache_{};
+    sqlite3_stmt* stmt_{};
+    Query query_{};
+    int column_count_{};
+    std::optional<Row> row_{};
+    bool done_{};
+    bool failed_{};
+public:
+    class iterator {
+        Cursor* cursor_{};
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+        using reference = Row const&;
+
+        iterator() = default;
+        explicit iterator(Cursor* cursor) : cursor_{cursor} {}
+
+        reference operator*() const {
+            return *cursor_->row_;
+        }
+        Row const* operator->() const {
+            return &*cursor_->row_;
+        }
+        iterator& operator++() {
+            cursor_->step();
+            return *this;
+        }
+        void operator++(int) {
+            cursor_->step();
+        }
+        [[nodiscard]] bool at_end() const {
+            return !cursor_ || !cursor_->row_;
+        }
+        friend bool operator==(iterator const& it, std::default_sentinel_t) {
+            return it.at_end();
+        }
+    };
+
+    ~Cursor();
+    /// No Copy
+    Cursor(Cursor const&) = delete;
+    Cursor& operator=(Cursor const&) = delete;
+    /// Move (the statement goes with the cursor)
+    Cursor(Cursor&& rhs) noexcept;
+    Cursor& operator=(Cursor&& rhs) noexcept;
+
+    /// Prepare the query and bind its arguments. No row is fetched yet.
+    static std::optional<Cursor> open(sqlite3* db, StmtCache* cache, Query query) noexcept;
+
+    /// Fetch the next row (std::nullopt at the end of data or on error).
+    std::optional<Row> next();
+
+    /// Check if the iteration was stopped by an error.
+    [[nodiscard]] bool failed() const noexcept {
+        return failed_;
+    }
+    /// Check if all rows were read.
+    [[nodiscard]] bool done() const noexcept {
+        return done_;
+    }
+
+    /// The first row is fetched by 'begin', the cursor can be iterated only once.
+    iterator begin() {
+        if (!row_ && !done_)
+            step();
+        return iterator{this};
+    }
+    static std::default_sentinel_t end() noexcept {
+        return std::default_sentinel;
+    }
+
+private:
+    Cursor(sqlite3* db, StmtCache* cache, Query&& query) : db_{db}, cache_{cache}, query_{std::move(query)} {}
+    /// Fetch the next row to 'row_'.
+    void step();
+    /// Give the statement back (to the cache) or finalize it.
+    void close() noexcept;
+};
@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/// Something that runs tasks (on its own threads).
+/// Implement it to plug an external executor (e.g. an event loop) into the library.
+class Executor {
+public:
+    virtual ~Executor() = default;
+    /// Schedule the task, must not block until the task is done.
+    virtual void post(std::function<void()> task) = 0;
+};
+
+/// Executor with one dedicated thread, tasks are run in order of posting.
+class ThreadExecutor final : public Executor {
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_{};
+    bool stop_{};
+    std::thread thread_;
+public:
+    ThreadExecutor();
+    /// Tasks already posted are run before the thread ends.
+    ~ThreadExecutor() override;
+    /// No Copy
+    ThreadExecutor(ThreadExecutor const&) = delete;
+    ThreadExecutor& operator=(ThreadExecutor const&) = delete;
+    /// No Move
+    ThreadExecutor(ThreadExecutor&&) = delete;
+    ThreadExecutor& operator=(ThreadExecutor&&) = delete;
+
+    void post(std::function<void()> task) override;
+
+private:
+    void run();
+};
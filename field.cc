@@ -49,28 +49,72 @@ to_string() const -> std::string {
 auto Field::
 to_bytes() const
 -> std::vector<char> {
+    std::vector<char> buffer(serialized_size());
+    Writer w{buffer};
+    write_to(w);
+    return buffer;
+}
+
+auto Field::
+serialized_size() const noexcept
+-> size_t {
+    auto const& [name, value] = data_;
+    return sizeof(char)     // marker
+        + sizeof(u32)       // chunk size
+        + sizeof(u16)       // name size
+        + name.size()       // name bytes
+        + value.serialized_size();
+}
+
+auto Field::
+write_to(Writer& w) const noexcept
+-> void {
     auto const& [name, value] = data_;
-    auto const value_bytes = value.to_bytes();
 
     // Chunk size does not include the marker and itself.
     // Total size describes everything that is behind it.
-    u16 const name_size = name.size();
-    u32 const chunk_size
-        = sizeof(u16)           // name size
-        + name.size()           // name bytes
-        + value_bytes.size();   // value bytes
-
-    std::vector<char> buffer{};
-    buffer.reserve(sizeof(char) + sizeof(u32) + chunk_size);
-
-    buffer.push_back('F');
-    std::copy_n(reinterpret_cast<u8 const*>(&chunk_size), sizeof(u32), std::back_inserter(buffer));
-    std::copy_n(reinterpret_cast<u8 const*>(&name_size), sizeof(u16), std::back_inserter(buffer));
-    std::copy_n(name.begin(), name_size, std::back_inserter(buffer));
-    std::copy_n(value_bytes.begin(), value_bytes.size(), std::back_inserter(buffer));
-    buffer.shrink_to_fit();
+    w.put('F');
+    auto const chunk = w.begin_chunk();
+    w.put(static_cast<u16>(name.size()));
+    w.put(name.data(), name.size());
+    value.write_to(w);
+    w.end_chunk(chunk);
+}
 
-    return buffer;
+/********************************************************************
+*                                                                   *
+*                              V 2                                  *
+*                                                                   *
+********************************************************************/
+
+auto Field::
+encoded_size_v2() const noexcept
+-> size_t {
+    auto const& [name, value] = data_;
+    return wire::varint_size(name.size()) + name.size() + value.encoded_size_v2();
+}
+
+auto Field::
+encode_v2(Writer& w) const noexcept
+-> void {
+    auto const& [name, value] = data_;
+    w.put_varint(name.size());
+    w.put(name.data(), name.size());
+    value.encode_v2(w);
+}
+
+auto Field::
+decode_v2(Reader& r)
+-> std::optional<Field> {
+    auto const name_size = r.varint();
+    if (!name_size)
+        return {};
+    auto const name = r.bytes(*name_size);
+    if (!name)
+        return {};
+    if (auto value = Value::decode_v2(r))
+        return Field{std::string{name->begin(), name->end()}, std::move(*value)};
+    return {};
 }
 
 /********************************************************************
@@ -28,6 +28,7 @@
 -------------------------------------------------------------------*/
 #include <string>
 #include <utility>
+#include <limits>
 #include "value.h"
 
 
@@ -71,6 +72,19 @@ public:
 
     /// Serialization. Converting a Field to bytes.
     [[nodiscard]] auto to_bytes() const -> std::vector<char>;
+    /// Number of bytes of the serialized field.
+    [[nodiscard]] auto serialized_size() const noexcept -> size_t;
+    /// Serialization directly into the writer.
+    auto write_to(Writer& w) const noexcept -> void;
+    /// The field fits V1 format (the name size is u16).
+    [[nodiscard]] bool fits_v1() const noexcept {
+        return data_.first.size() <= std::numeric_limits<u16>::max();
+    }
+
+    /// V2 encoding of the field inside of V2 frame.
+    [[nodiscard]] auto encoded_size_v2() const noexcept -> size_t;
+    auto encode_v2(Writer& w) const noexcept -> void;
+    static auto decode_v2(Reader& r) -> std::optional<Field>;
 
     /// Deserialization. Recreate Field from bytes.
     static std::pair<Field,size_t> from_bytes(std::span<const char> span);
@@ -26,39 +26,18 @@
 
 /*------- include files:
 -------------------------------------------------------------------*/
-#include <vector>
-#include <boost/iostreams/copy.hpp>
-#include <boost/iostreams/filter/gzip.hpp>
-#include <boost/iostreams/filtering_stream.hpp>
-#include <boost/iostreams/filtering_streambuf.hpp>
-namespace bio = boost::iostreams;
+#include "codec.h"
 
+/// gzip compression, kept for compatibility (see codec.h).
 namespace gzip {
     /// Compress data using gzip.
     static inline auto compress(std::span<const char> const plain) {
-        std::vector<char> buffer{};
-
-        bio::filtering_ostream in;
-        //in.push(bio::gzip_compressor(bio::gzip::best_compression));
-        in.push(bio::gzip_compressor(bio::gzip::best_speed));
-        in.push(bio::back_inserter(buffer));
-        bio::write(in, plain.data(), static_cast<uint>(plain.size()));
-
-        buffer.shrink_to_fit();
-        return buffer;
+        return codec::compress(plain, {codec::GZIP}).value_or(std::vector<char>{});
     }
 
     /// Decompress data uzing gzip.
     static inline std::vector<char> decompress(std::span<const char> const compressed) {
-        std::vector<char> buffer{};
-
-        bio::filtering_ostream in;
-        in.push(bio::gzip_decompressor());
-        in.push(bio::back_inserter(buffer));
-        bio::write(in, compressed.data(), static_cast<uint>(compressed.size()));
-
-        buffer.shrink_to_fit();
-        return buffer;
+        return codec::gunzip(compressed).value_or(std::vector<char>{});
     }
 
 }
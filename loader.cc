@@ -0,0 +1,961 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "loader.h"
+#include "logger.h"
+#include "shared.h"
+#include "stmt.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <map>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr auto NPOS = std::string_view::npos;
+
+    /****************************************************************
+    *                                                               *
+    *                           I N P U T                           *
+    *                                                               *
+    ****************************************************************/
+
+    /// The file mapped to memory, or read as a stream if it can't be mapped (e.g. a pipe).
+    class Input {
+        int fd_{-1};
+        char const* map_{};
+        size_t size_{};
+    public:
+        Input() = default;
+        ~Input() {
+            if (map_)
+                munmap(const_cast<char*>(map_), size_);
+            if (fd_ >= 0)
+                close(fd_);
+        }
+        /// No Copy
+        Input(Input const&) = delete;
+        Input& operator=(Input const&) = delete;
+        /// No Move
+        Input(Input&&) = delete;
+        Input& operator=(Input&&) = delete;
+
+        bool open(fs::path const& path) {
+            fd_ = ::open(path.c_str(), O_RDONLY);
+            if (fd_ < 0)
+                return false;
+            struct stat st{};
+            if (fstat(fd_, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+                size_ = static_cast<size_t>(st.st_size);
+                if (auto const p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0); p != MAP_FAILED) {
+                    map_ = static_cast<char const*>(p);
+                    madvise(p, size_, MADV_SEQUENTIAL);
+                    return true;
+                }
+            }
+            // The descriptor is kept for reading (a pipe can't be opened again).
+            size_ = 0;
+            return true;
+        }
+
+        [[nodiscard]] bool mapped() const noexcept {
+            return map_ != nullptr;
+        }
+        /// Size of the mapped file (0 for streams, the size is not known).
+        [[nodiscard]] u64 size() const noexcept {
+            return size_;
+        }
+        [[nodiscard]] std::span<const char> data() const noexcept {
+            return {map_, size_};
+        }
+        /// Append up to n bytes to the buffer, returns the number of bytes read (0 - end or error).
+        size_t read(std::vector<char>& buffer, size_t const n) {
+            auto const old = buffer.size();
+            buffer.resize(old + n);
+            size_t got{};
+            while (got < n) {
+                auto const k = ::read(fd_, buffer.data() + old + got, n - got);
+                if (k < 0 && errno == EINTR)
+                    continue;
+                if (k <= 0)
+                    break;
+                got += static_cast<size_t>(k);
+            }
+            buffer.resize(old + got);
+            return got;
+        }
+    };
+
+    /// Position after the newline ending the record that contains the byte 'from'
+    /// (data starts at a record start), NPOS if there is no such newline.
+    /// With a quote character, newlines inside quoted fields don't end records.
+    size_t record_end(std::span<const char> const data, size_t const from, char const quote) noexcept {
+        auto const p = data.data();
+        auto const n = data.size();
+        if (from >= n)
+            return NPOS;
+        auto const find = [p](size_t const i, size_t const end, char const c) -> size_t {
+            auto const found = static_cast<char const*>(std::memchr(p + i, c, end - i));
+            return found ? static_cast<size_t>(found - p) : NPOS;
+        };
+        if (!quote) {
+            auto const nl = find(from, n, '\n');
+            return nl == NPOS ? NPOS : nl + 1;
+        }
+
+        // Doubled quotes ("") toggle the state twice, so the parity of all quotes tells the state.
+        auto in_quotes = (std::count(p, p + from, quote) & 1) != 0;
+        for (auto i = from; i < n;) {
+            if (in_quotes) {
+                auto const q = find(i, n, quote);
+                if (q == NPOS)
+                    return NPOS;
+                in_quotes = false;
+                i = q + 1;
+                continue;
+            }
+            auto const nl = find(i, n, '\n');
+            auto const q = find(i, nl == NPOS ? n : nl, quote);
+            if (q == NPOS)
+                return nl == NPOS ? NPOS : nl + 1;
+            in_quotes = true;
+            i = q + 1;
+        }
+        return NPOS;
+    }
+
+    /****************************************************************
+    *                                                               *
+    *                         C H U N K E R                         *
+    *                                                               *
+    ****************************************************************/
+
+    struct Chunk {
+        u64 index{};
+        u64 offset{};
+        std::vector<char> storage{};    // used when the input is a stream
+        std::span<const char> data{};
+    };
+
+    /// Splits the input into chunks of whole records (called by one thread at a time).
+    class Chunker {
+        Input& input_;
+        size_t const chunk_size_;
+        char const quote_;
+        u64 index_{};
+        u64 offset_{};
+        std::vector<char> carry_{};     // stream: bytes read and not yet given in a chunk
+        bool eof_{};
+    public:
+        Chunker(Input& input, size_t const chunk_size, char const quote)
+            : input_{input}, chunk_size_{std::max<size_t>(chunk_size, 1)}, quote_{quote} {}
+
+        [[nodiscard]] u64 offset() const noexcept {
+            return offset_;
+        }
+
+        /// The first record, removed from the input if 'consume'.
+        std::optional<std::string> first_record(bool const consume) {
+            size_t end;
+            std::string_view text;
+            if (input_.mapped()) {
+                auto const data = input_.data();
+                end = record_end(data, 0, quote_);
+                if (end == NPOS)
+                    end = data.size();
+                text = {data.data(), end};
+            }
+            else {
+                while ((end = record_end(carry_, 0, quote_)) == NPOS && !eof_)
+                    eof_ = input_.read(carry_, chunk_size_) == 0;
+                if (end == NPOS)
+                    end = carry_.size();
+                text = {carry_.data(), end};
+            }
+            if (text.empty())
+                return {};
+            std::string record{text};
+            if (consume) {
+                if (!input_.mapped())
+                    carry_.erase(carry_.begin(), carry_.begin() + static_cast<std::ptrdiff_t>(end));
+                offset_ += end;
+            }
+            return record;
+        }
+
+        std::optional<Chunk> next() {
+            if (input_.mapped()) {
+                auto const data = input_.data();
+                if (offset_ >= data.size())
+                    return {};
+                auto const rest = data.subspan(offset_);
+                auto end = rest.size() > chunk_size_ ? record_end(rest, chunk_size_, quote_) : rest.size();
+                if (end == NPOS)
+                    end = rest.size();
+                Chunk chunk{index_++, offset_, {}, rest.first(end)};
+                offset_ += end;
+                return chunk;
+            }
+
+            for (;;) {
+                if (!eof_ && carry_.size() <= chunk_size_) {
+                    eof_ = input_.read(carry_, chunk_size_) == 0;
+                    continue;
+                }
+                if (carry_.empty())
+                    return {};
+                auto end = carry_.size() > chunk_size_ ? record_end(carry_, chunk_size_, quote_) : NPOS;
+                if (end == NPOS) {
+                    if (!eof_) {
+                        // The record is longer than the chunk.
+                        eof_ = input_.read(carry_, chunk_size_) == 0;
+                        continue;
+                    }
+                    end = carry_.size();
+                }
+                auto const split = carry_.begin() + static_cast<std::ptrdiff_t>(end);
+                Chunk chunk{index_++, offset_, {carry_.begin(), split}, {}};
+                chunk.data = chunk.storage;
+                carry_.erase(carry_.begin(), split);
+                offset_ += end;
+                return chunk;
+            }
+        }
+    };
+
+    /****************************************************************
+    *                                                               *
+    *                          P A R S E R S                        *
+    *                                                               *
+    ****************************************************************/
+
+    struct Field {
+        std::string_view text{};
+        bool quoted{};      // CSV: quoted field, JSON: string, object or array
+        bool null{};        // JSON null
+    };
+
+    /// Fields of the record (views into the data or into 'scratch').
+    struct Record {
+        std::vector<Field> fields{};
+        std::deque<std::string> scratch{};
+        void clear() {
+            fields.clear();
+            scratch.clear();
+        }
+    };
+
+    std::string_view trim_cr(std::string_view text) noexcept {
+        if (!text.empty() && text.back() == '\r')
+            text.remove_suffix(1);
+        return text;
+    }
+
+    /// Parse the CSV record starting at 'pos'.
+    /// Returns the position after the record, NPOS if the record is malformed.
+    size_t parse_csv(std::string_view const data, size_t pos, char const delimiter, char const quote, Record& record) {
+        record.clear();
+        auto nl = data.find('\n', pos);
+        auto const line_end = nl == NPOS ? data.size() : nl;
+        auto const next = nl == NPOS ? data.size() : nl + 1;
+        auto const line = trim_cr(data.substr(pos, line_end - pos));
+
+        // Fast path: no quotes in the line, fields are found with memchr.
+        if (line.find(quote) == NPOS) {
+            for (size_t start = 0;;) {
+                auto const d = line.find(delimiter, start);
+                record.fields.push_back({line.substr(start, d == NPOS ? NPOS : d - start)});
+                if (d == NPOS)
+                    break;
+                start = d + 1;
+            }
+            return next;
+        }
+
+        // Quoted fields (they may contain delimiters, newlines and doubled quotes).
+        auto const n = data.size();
+        for (auto i = pos;;) {
+            if (i < n && data[i] == quote) {
+                std::string value{};
+                for (auto start = ++i;;) {
+                    auto const q = data.find(quote, i);
+                    if (q == NPOS)
+                        return NPOS;
+                    if (q + 1 < n && data[q + 1] == quote) {
+                        value.append(data.substr(start, q + 1 - start));
+                        i = start = q + 2;
+                        continue;
+                    }
+                    value.append(data.substr(start, q - start));
+                    i = q + 1;
+                    break;
+                }
+                record.fields.push_back({record.scratch.emplace_back(std::move(value)), true});
+            }
+            else {
+                auto j = i;
+                while (j < n && data[j] != delimiter && data[j] != '\n')
+                    ++j;
+                auto text = data.substr(i, j - i);
+                if (j == n || data[j] == '\n')
+                    text = trim_cr(text);
+                record.fields.push_back({text});
+                i = j;
+            }
+            if (i >= n)
+                return n;
+            if (data[i] == delimiter) {
+                ++i;
+                continue;
+            }
+            if (data[i] == '\r')
+                ++i;
+            if (i >= n)
+                return n;
+            if (data[i] == '\n')
+                return i + 1;
+            return NPOS;    // something after the closing quote
+        }
+    }
+
+    /// Parser of one NDJSON line: an object with values of any JSON type
+    /// (objects and arrays are kept as JSON text).
+    class JsonLine {
+        std::string_view s_;
+        size_t i_{};
+        Record& record_;
+    public:
+        JsonLine(std::string_view const line, Record& record) : s_{line}, record_{record} {}
+
+        /// Keys and values of the object, false if the line is not a JSON object.
+        bool parse(std::vector<std::string_view>& keys) {
+            record_.clear();
+            keys.clear();
+            ws();
+            if (!eat('{'))
+                return false;
+            ws();
+            if (eat('}'))
+                return end();
+            for (;;) {
+                ws();
+                auto const key = string();
+                if (!key)
+                    return false;
+                ws();
+                if (!eat(':'))
+                    return false;
+                ws();
+                auto const v = value();
+                if (!v)
+                    return false;
+                keys.push_back(*key);
+                record_.fields.push_back(*v);
+                ws();
+                if (eat(','))
+                    continue;
+                if (eat('}'))
+                    return end();
+                return false;
+            }
+        }
+
+    private:
+        void ws() noexcept {
+            while (i_ < s_.size() && (s_[i_] == ' ' || s_[i_] == '\t' || s_[i_] == '\r' || s_[i_] == '\n'))
+                ++i_;
+        }
+        bool eat(char const c) noexcept {
+            if (i_ < s_.size() && s_[i_] == c) {
+                ++i_;
+                return true;
+            }
+            return false;
+        }
+        bool end() noexcept {
+            ws();
+            return i_ == s_.size();
+        }
+
+        static void utf8(std::string& out, u32 const cp) {
+            if (cp < 0x80)
+                out += static_cast<char>(cp);
+            else if (cp < 0x800) {
+                out += static_cast<char>(0xC0 | cp >> 6);
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else if (cp < 0x10000) {
+                out += static_cast<char>(0xE0 | cp >> 12);
+                out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else {
+                out += static_cast<char>(0xF0 | cp >> 18);
+                out += static_cast<char>(0x80 | (cp >> 12 & 0x3F));
+                out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+        }
+
+        std::optional<u32> hex4() noexcept {
+            if (i_ + 4 > s_.size())
+                return {};
+            u32 cp{};
+            auto const [ptr, ec] = std::from_chars(s_.data() + i_, s_.data() + i_ + 4, cp, 16);
+            if (ec != std::errc{} || ptr != s_.data() + i_ + 4)
+                return {};
+            i_ += 4;
+            return cp;
+        }
+
+        /// String at the current position (a view of the line if it has no escapes).
+        std::optional<std::string_view> string() {
+            if (!eat('"'))
+                return {};
+            auto const start = i_;
+            auto const close = s_.find('"', i_);
+            if (close == NPOS)
+                return {};
+            if (s_.substr(start, close - start).find('\\') == NPOS) {
+                i_ = close + 1;
+                return s_.substr(start, close - start);
+            }
+
+            std::string out{};
+            while (i_ < s_.size()) {
+                auto const c = s_[i_++];
+                if (c == '"')
+                    return record_.scratch.emplace_back(std::move(out));
+                if (c != '\\') {
+                    out += c;
+                    continue;
+                }
+                if (i_ >= s_.size())
+                    return {};
+                switch (s_[i_++]) {
+                    case '"': out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/': out += '/'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u': {
+                        auto cp = hex4();
+                        if (!cp)
+                            return {};
+                        // Surrogate pair.
+                        if (*cp >= 0xD800 && *cp < 0xDC00 && s_.substr(i_, 2) == "\\u") {
+                            i_ += 2;
+                            auto const low = hex4();
+                            if (!low || *low < 0xDC00 || *low > 0xDFFF)
+                                return {};
+                            *cp = 0x10000 + ((*cp - 0xD800) << 10) + (*low - 0xDC00);
+                        }
+                        utf8(out, *cp);
+                        break;
+                    }
+                    default:
+                        return {};
+                }
+            }
+            return {};
+        }
+
+        /// Skip the object or array, returns its text.
+        std::optional<std::string_view> nested() noexcept {
+            auto const start = i_;
+            int depth = 0;
+            while (i_ < s_.size()) {
+                auto const c = s_[i_++];
+                if (c == '"') {
+                    // Skip the string with its escapes.
+                    while (i_ < s_.size() && s_[i_] != '"')
+                        i_ += s_[i_] == '\\' ? 2 : 1;
+                    if (i_ >= s_.size())
+                        return {};
+                    ++i_;
+                }
+                else if (c == '{' || c == '[')
+                    ++depth;
+                else if ((c == '}' || c == ']') && --depth == 0)
+                    return s_.substr(start, i_ - start);
+            }
+            return {};
+        }
+
+        std::optional<Field> value() {
+            if (i_ >= s_.size())
+                return {};
+            switch (auto const c = s_[i_]) {
+                case '"':
+                    if (auto const text = string())
+                        return Field{*text, true};
+                    return {};
+                case '{':
+                case '[':
+                    if (auto const text = nested())
+                        return Field{*text, true};
+                    return {};
+                default:
+                    if (s_.substr(i_, 4) == "null") {
+                        i_ += 4;
+                        return Field{{}, false, true};
+                    }
+                    if (s_.substr(i_, 4) == "true") {
+                        i_ += 4;
+                        return Field{"1"};
+                    }
+                    if (s_.substr(i_, 5) == "false") {
+                        i_ += 5;
+                        return Field{"0"};
+                    }
+                    if (c == '-' || (c >= '0' && c <= '9')) {
+                        auto const start = i_;
+                        while (i_ < s_.size() && s_[i_] != '\0' && std::strchr("+-0123456789.eE", s_[i_]))
+                            ++i_;
+                        return Field{s_.substr(start, i_ - start)};
+                    }
+                    return {};
+            }
+        }
+    };
+
+    /// Value of the field converted to the column type (std::nullopt if it can't be converted).
+    std::optional<Value> to_value(Field const& field, LoadColumn::Type const type) {
+        using enum LoadColumn::Type;
+        auto text = field.text;
+        if (field.null)
+            return Value{};
+
+        auto const integer = [&text]() -> std::optional<i64> {
+            auto t = text;
+            if (!t.empty() && t.front() == '+')
+                t.remove_prefix(1);
+            i64 v{};
+            auto const [ptr, ec] = std::from_chars(t.data(), t.data() + t.size(), v);
+            if (t.empty() || ec != std::errc{} || ptr != t.data() + t.size())
+                return {};
+            return v;
+        };
+        auto const real = [&text]() -> std::optional<f64> {
+            auto t = text;
+            if (!t.empty() && t.front() == '+')
+                t.remove_prefix(1);
+            f64 v{};
+            auto const [ptr, ec] = std::from_chars(t.data(), t.data() + t.size(), v);
+            if (t.empty() || ec != std::errc{} || ptr != t.data() + t.size())
+                return {};
+            return v;
+        };
+
+        switch (type) {
+            case AUTO:
+                if (field.quoted)
+                    return Value{text};
+                if (text.empty())
+                    return Value{};
+                if (auto const v = integer())
+                    return Value{*v};
+                if (auto const v = real())
+                    return Value{*v};
+                return Value{text};
+            case INTEGER:
+                if (text.empty() && !field.quoted)
+                    return Value{};
+                if (auto const v = integer())
+                    return Value{*v};
+                return {};
+            case REAL:
+                if (text.empty() && !field.quoted)
+                    return Value{};
+                if (auto const v = real())
+                    return Value{*v};
+                return {};
+            case TEXT:
+                return Value{text};
+        }
+        return {};
+    }
+
+    /****************************************************************
+    *                                                               *
+    *                         P I P E L I N E                       *
+    *                                                               *
+    ****************************************************************/
+
+    /// Rows parsed from one chunk.
+    struct Batch {
+        u64 bytes{};
+        u64 rejected{};
+        std::vector<std::vector<Value>> rows{};
+        bool failed{};
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view const text) const noexcept {
+            return std::hash<std::string_view>{}(text);
+        }
+    };
+
+    /// How the fields of a record become the row.
+    struct Mapping {
+        std::vector<LoadColumn::Type> types{};
+        /// CSV: field position of every column.
+        std::vector<size_t> fields{};
+        /// NDJSON: column of every key.
+        std::unordered_map<std::string, size_t, StringHash, std::equal_to<>> keys{};
+    };
+}
+
+auto LoadProgress::
+bytes_per_second() const noexcept
+-> double {
+    auto const s = std::chrono::duration<double>(elapsed).count();
+    return s > 0 ? static_cast<double>(bytes_done) / s : 0.0;
+}
+
+auto LoadProgress::
+rows_per_second() const noexcept
+-> double {
+    auto const s = std::chrono::duration<double>(elapsed).count();
+    return s > 0 ? static_cast<double>(rows) / s : 0.0;
+}
+
+/********************************************************************
+*                                                                   *
+*                              E X E C                              *
+*                                                                   *
+********************************************************************/
+
+auto FileLoader::
+exec(std::string const& table, fs::path const& path) const noexcept
+-> std::optional<LoadProgress> {
+    auto const start = std::chrono::steady_clock::now();
+    auto const csv = options_.format == LoadOptions::Format::CSV;
+    auto const quote = csv ? options_.quote : '\0';
+
+    try {
+        Input input{};
+        if (!input.open(path)) {
+            logger::error("The file {} can't be opened.", path.string());
+            return {};
+        }
+        Chunker chunker{input, options_.chunk_size, quote};
+
+        // Columns of the table and where their values come from.
+        auto columns = options_.columns;
+        Mapping mapping{};
+        if (csv) {
+            std::vector<std::string> header{};
+            if (options_.header) {
+                if (auto const line = chunker.first_record(true)) {
+                    Record record{};
+                    if (NPOS == parse_csv(*line, 0, options_.delimiter, options_.quote, record)) {
+                        logger::error("The CSV header of {} is malformed.", path.string());
+                        return {};
+                    }
+                    for (auto const& f : record.fields)
+                        header.emplace_back(f.text);
+                }
+            }
+            if (columns.empty()) {
+                if (header.empty()) {
+                    logger::error("Columns must be given for CSV without a header ({}).", path.string());
+                    return {};
+                }
+                for (size_t i = 0; i < header.size(); ++i)
+                    columns.push_back({.name = header[i], .field = i});
+            }
+            for (auto const& column : columns) {
+                auto field = column.field;
+                if (!field) {
+                    auto const& name = column.source.empty() ? column.name : column.source;
+                    if (auto const it = std::ranges::find(header, name); it != header.end())
+                        field = static_cast<size_t>(it - header.begin());
+                }
+                if (!field) {
+                    logger::error("There is no field for the column {} in {}.", column.name, path.string());
+                    return {};
+                }
+                mapping.fields.push_back(*field);
+            }
+        }
+        else {
+            if (columns.empty()) {
+                if (auto const line = chunker.first_record(false)) {
+                    Record record{};
+                    std::vector<std::string_view> keys{};
+                    if (JsonLine{*line, record}.parse(keys))
+                        for (auto const key : keys)
+                            columns.push_back({.name = std::string{key}});
+                }
+            }
+            for (size_t i = 0; i < columns.size(); ++i)
+                mapping.keys.emplace(columns[i].source.empty() ? columns[i].name : columns[i].source, i);
+        }
+        if (columns.empty()) {
+            logger::error("There are no columns to load from {}.", path.string());
+            return {};
+        }
+        for (auto const& column : columns)
+            mapping.types.push_back(column.type);
+
+        // Parse the chunk to the batch of rows.
+        auto const parse = [&](Chunk const& chunk) {
+            Batch batch{.bytes = chunk.data.size()};
+            std::string_view const data{chunk.data.data(), chunk.data.size()};
+            Record record{};
+            std::vector<std::string_view> keys{};
+            std::vector<Value> row{};
+
+            for (size_t pos = 0; pos < data.size();) {
+                auto const record_start = pos;
+                auto valid = true;
+                if (csv) {
+                    auto const next = parse_csv(data, pos, options_.delimiter, options_.quote, record);
+                    if (next == NPOS) {
+                        // The malformed record ends at the next newline.
+                        auto const nl = data.find('\n', pos);
+                        pos = nl == NPOS ? data.size() : nl + 1;
+                        valid = false;
+                    }
+                    else
+                        pos = next;
+                    // Blank lines are skipped.
+                    if (valid && record.fields.size() == 1 && record.fields[0].text.empty() && !record.fields[0].quoted)
+                        continue;
+                    if (valid) {
+                        row.assign(columns.size(), Value{});
+                        for (size_t c = 0; c < columns.size() && valid; ++c) {
+                            if (mapping.fields[c] >= record.fields.size())
+                                continue;   // missing trailing fields are NULL
+                            if (auto v = to_value(record.fields[mapping.fields[c]], mapping.types[c]))
+                                row[c] = std::move(*v);
+                            else
+                                valid = false;
+                        }
+                    }
+                }
+                else {
+                    auto const nl = data.find('\n', pos);
+                    auto const line = data.substr(pos, nl == NPOS ? NPOS : nl - pos);
+                    pos = nl == NPOS ? data.size() : nl + 1;
+                    if (trim_cr(line).find_first_not_of(" \t") == NPOS)
+                        continue;
+                    valid = JsonLine{line, record}.parse(keys);
+                    if (valid) {
+                        row.assign(columns.size(), Value{});
+                        for (size_t k = 0; k < keys.size() && valid; ++k) {
+                            auto const it = mapping.keys.find(keys[k]);
+                            if (it == mapping.keys.end())
+                                continue;   // keys without a column are ignored
+                            if (auto v = to_value(record.fields[k], mapping.types[it->second]))
+                                row[it->second] = std::move(*v);
+                            else
+                                valid = false;
+                        }
+                    }
+                }
+
+                if (valid)
+                    batch.rows.push_back(std::move(row));
+                else if (options_.skip_invalid)
+                    ++batch.rejected;
+                else {
+                    logger::error("Invalid record at byte {} of {}.", chunk.offset + record_start, path.string());
+                    batch.failed = true;
+                    break;
+                }
+            }
+            return batch;
+        };
+
+        // Workers take chunks in order and put parsed batches to 'ready',
+        // the writer (this thread) takes them in the same order.
+        std::mutex mutex;
+        std::mutex chunker_mutex;
+        std::condition_variable batch_ready;
+        std::condition_variable space_free;
+        std::map<u64, Batch> ready{};
+        u64 next_batch{};
+        uint finished{};
+        auto stop = false;
+        auto broken = false;
+        auto const max_pending = std::max<size_t>(options_.max_pending_chunks, 1);
+        auto const threads = options_.threads ? options_.threads : std::max(1u, std::thread::hardware_concurrency());
+
+        auto const work = [&] {
+            for (;;) {
+                std::optional<Chunk> chunk{};
+                Batch batch{};
+                try {
+                    {
+                        std::lock_guard lock{chunker_mutex};
+                        chunk = chunker.next();
+                    }
+                    if (chunk) {
+                        {
+                            std::unique_lock lock{mutex};
+                            space_free.wait(lock, [&] { return stop || chunk->index < next_batch + max_pending; });
+                            if (stop)
+                                break;
+                        }
+                        batch = parse(*chunk);
+                    }
+                }
+                catch (...) {
+                    // e.g. no memory, the load is stopped
+                    {
+                        std::lock_guard lock{mutex};
+                        broken = true;
+                    }
+                    batch_ready.notify_all();
+                    break;
+                }
+                if (!chunk)
+                    break;
+                {
+                    std::lock_guard lock{mutex};
+                    ready.emplace(chunk->index, std::move(batch));
+                }
+                batch_ready.notify_all();
+            }
+            {
+                std::lock_guard lock{mutex};
+                ++finished;
+            }
+            batch_ready.notify_all();
+        };
+
+        LoadProgress progress{.bytes_total = input.size(), .bytes_done = chunker.offset()};
+        Batch current{};
+        size_t row_index{};
+        auto failed = false;
+        auto cancelled = false;
+
+        // The next batch in file order (std::nullopt when all are done or the load is stopped).
+        auto const take = [&]() -> std::optional<Batch> {
+            std::unique_lock lock{mutex};
+            batch_ready.wait(lock, [&] { return broken || ready.contains(next_batch) || finished == threads; });
+            if (broken)
+                return Batch{.failed = true};
+            auto const it = ready.find(next_batch);
+            if (it == ready.end())
+                return {};
+            auto batch = std::move(it->second);
+            ready.erase(it);
+            ++next_batch;
+            lock.unlock();
+            space_free.notify_all();
+            return batch;
+        };
+
+        // A failed or cancelled load throws, BulkInsert then rolls back the current transaction
+        // (returning false would commit it as if the file ended there).
+        auto const source = [&](std::vector<Value>& values) {
+            while (row_index == current.rows.size()) {
+                auto batch = take();
+                if (!batch)
+                    return false;
+                if (batch->failed) {
+                    failed = true;
+                    throw BulkInsert::Abort{};
+                }
+                progress.bytes_done += batch->bytes;
+                progress.rows += batch->rows.size();
+                progress.rejected += batch->rejected;
+                progress.elapsed = std::chrono::steady_clock::now() - start;
+                current = std::move(*batch);
+                row_index = 0;
+                // Rows of the batch are counted when it is taken (before they are inserted).
+                if (options_.progress && !options_.progress(progress)) {
+                    cancelled = true;
+                    throw BulkInsert::Abort{};
+                }
+            }
+            values = std::move(current.rows[row_index++]);
+            return true;
+        };
+
+        std::string names{};
+        std::string placeholders{};
+        for (auto const& column : columns) {
+            if (!names.empty()) {
+                names += ", ";
+                placeholders += ", ";
+            }
+            names += shared::quote_identifier(column.name);
+            placeholders += '?';
+        }
+        auto const sql = std::format("INSERT INTO {} ({}) VALUES ({})", shared::quote_identifier(table), names, placeholders);
+
+        std::optional<std::vector<i64>> inserted{};
+        {
+            std::vector<std::jthread> workers{};
+            workers.reserve(threads);
+            for (uint i = 0; i < threads; ++i)
+                workers.emplace_back(work);
+
+            BulkOptions const bulk{.batch_size = options_.rows_per_transaction, .rowids = false};
+            inserted = BulkInsert(db_, cache_, stats_, bulk).exec(sql, source);
+
+            {
+                std::lock_guard lock{mutex};
+                stop = true;
+            }
+            space_free.notify_all();
+        }
+
+        if (cancelled) {
+            logger::info("Loading of {} was cancelled.", path.string());
+            return {};
+        }
+        if (!inserted || failed)
+            return {};
+        if (progress.bytes_total == 0)
+            progress.bytes_total = progress.bytes_done;
+        progress.elapsed = std::chrono::steady_clock::now() - start;
+        return progress;
+    }
+    catch (...) {
+        return {};
+    }
+}
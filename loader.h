@@ -0,0 +1,111 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include "value.h"
+#include "bulk.h"
+#include "stmt_cache.h"
+#include "transaction.h"
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+
+/// Column of the table filled from a field of the input.
+struct LoadColumn {
+    enum class Type : u8 {
+        AUTO,       // INTEGER, REAL or TEXT, whatever the field looks like (empty CSV field - NULL)
+        INTEGER,
+        REAL,
+        TEXT
+    };
+    /// Column of the table.
+    std::string name;
+    /// CSV header name or NDJSON key (empty - the same as the column name).
+    std::string source{};
+    /// Position of the CSV field (used instead of the name, required for CSV without a header).
+    std::optional<size_t> field{};
+    Type type{Type::AUTO};
+};
+
+struct LoadProgress {
+    u64 bytes_total{};
+    u64 bytes_done{};
+    u64 rows{};
+    /// Rows skipped because they could not be parsed or converted (see LoadOptions::skip_invalid).
+    u64 rejected{};
+    std::chrono::nanoseconds elapsed{};
+
+    [[nodiscard]] double bytes_per_second() const noexcept;
+    [[nodiscard]] double rows_per_second() const noexcept;
+};
+
+struct LoadOptions {
+    enum class Format : u8 { CSV, NDJSON };
+
+    Format format{Format::CSV};
+    char delimiter{','};
+    char quote{'"'};
+    /// The first CSV line contains names of fields.
+    bool header{true};
+    /// Columns to fill. Empty - all fields of the CSV header, or all keys of the first NDJSON object.
+    std::vector<LoadColumn> columns{};
+    /// Skip rows that can't be parsed (they are counted as rejected) instead of stopping the load.
+    bool skip_invalid{false};
+    /// Approximate size of a chunk parsed by one worker (chunks end at a record end).
+    size_t chunk_size{4 << 20};
+    /// Parsing threads (0 - one per hardware thread).
+    uint threads{0};
+    /// Parsed chunks waiting for the writer, limits the memory used.
+    size_t max_pending_chunks{16};
+    /// Rows inserted in one transaction.
+    size_t rows_per_transaction{100'000};
+    /// Called when a parsed chunk is taken for inserting (its rows are already counted), returns false
+    /// to cancel the load. The chunk is then not inserted and the current transaction is rolled back.
+    std::function<bool(LoadProgress const&)> progress{};
+};
+
+/// Parallel loader of CSV and NDJSON files. \n
+/// The file is memory-mapped (or read, if it can't be mapped) and split into chunks ending at
+/// record ends (newlines inside quoted CSV fields are skipped). Workers parse chunks to rows of Values,
+/// the calling thread inserts them in file order with one prepared INSERT (see BulkInsert).
+/// Rows of transactions committed before an error or a cancellation stay in the table.
+class FileLoader {
+    sqlite3* db_{};
+    StmtCache* cache_{};
+    TransactionStats* stats_{};
+    LoadOptions options_{};
+public:
+    FileLoader(sqlite3* db, StmtCache* cache, TransactionStats* stats, LoadOptions options)
+        : db_{db}, cache_{cache}, stats_{stats}, options_{std::move(options)} {}
+
+    /// Load the file to the table. Returns the final progress (std::nullopt on error or cancellation).
+    std::optional<LoadProgress> exec(std::string const& table, fs::path const& path) const noexcept;
+};
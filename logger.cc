@@ -0,0 +1,366 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "logger.h"
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <ctime>
+#include <thread>
+
+namespace logger {
+    namespace {
+        constexpr size_t RING_CAPACITY{8192};           // power of two
+        constexpr size_t RATE_SLOTS{1024};              // call sites hashed to slots
+        constexpr uint DEFAULT_RATE_LIMIT{10};          // records per second per site
+
+        /// Set when the logger is destroyed (at exit), later records go straight to stderr.
+        std::atomic<bool> shutdown{false};
+
+        /****************************************************************
+        *                                                               *
+        *                     R I N G   B U F F E R                     *
+        *                                                               *
+        ****************************************************************/
+
+        /// Bounded multi-producer, single-consumer queue (Vyukov).
+        /// Every slot has a sequence number telling whose turn it is.
+        class RingBuffer {
+            struct Slot {
+                std::atomic<size_t> sequence;
+                Record record;
+            };
+            std::unique_ptr<Slot[]> slots_;
+            size_t const mask_;
+            alignas(64) std::atomic<size_t> head_{};    // producers
+            alignas(64) size_t tail_{};                 // consumer
+        public:
+            explicit RingBuffer(size_t const capacity)
+                : slots_{std::make_unique<Slot[]>(capacity)}, mask_{capacity - 1} {
+                for (size_t i = 0; i < capacity; ++i)
+                    slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            /// False if the buffer is full.
+            bool push(Record&& record) noexcept {
+                auto pos = head_.load(std::memory_order_relaxed);
+                for (;;) {
+                    auto& slot = slots_[pos & mask_];
+                    auto const seq = slot.sequence.load(std::memory_order_acquire);
+                    auto const diff = static_cast<i64>(seq) - static_cast<i64>(pos);
+                    if (diff == 0) {
+                        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            slot.record = std::move(record);
+                            slot.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                        return false;
+                    else
+                        pos = head_.load(std::memory_order_relaxed);
+                }
+            }
+
+            /// Only the consumer thread may call it.
+            bool pop(Record& record) noexcept {
+                auto& slot = slots_[tail_ & mask_];
+                if (slot.sequence.load(std::memory_order_acquire) != tail_ + 1)
+                    return false;
+                record = std::move(slot.record);
+                slot.sequence.store(tail_ + mask_ + 1, std::memory_order_release);
+                ++tail_;
+                return true;
+            }
+
+            /// Only the consumer thread may call it.
+            [[nodiscard]] bool empty() const noexcept {
+                return slots_[tail_ & mask_].sequence.load(std::memory_order_acquire) != tail_ + 1;
+            }
+        };
+
+        /****************************************************************
+        *                                                               *
+        *                       R A T E   L I M I T                     *
+        *                                                               *
+        ****************************************************************/
+
+        struct RateSlot {
+            std::atomic<i64> second{};
+            std::atomic<u32> count{};
+            std::atomic<u32> suppressed{};
+        };
+
+        /****************************************************************
+        *                                                               *
+        *                           L O G G E R                         *
+        *                                                               *
+        ****************************************************************/
+
+        class Logger {
+            RingBuffer ring_{RING_CAPACITY};
+            std::array<RateSlot, RATE_SLOTS> rates_{};
+            std::atomic<uint> rate_limit_{DEFAULT_RATE_LIMIT};
+            std::mutex sink_mutex_;
+            std::shared_ptr<Sink> sink_{std::make_shared<StderrSink>()};
+            std::atomic<u64> pushed_{};
+            std::atomic<u64> written_{};
+            std::atomic<u64> dropped_{};
+            std::atomic<u64> suppressed_{};
+            std::atomic<bool> sleeping_{};
+            std::atomic<bool> stop_{};
+            std::thread thread_;
+        public:
+            static Logger& self() {
+                static Logger logger;
+                return logger;
+            }
+            Logger() : thread_{[this] { run(); }} {}
+            /// Records already pushed are written before the thread ends.
+            ~Logger() {
+                stop_.store(true);
+                wake();
+                thread_.join();
+                shutdown.store(true);
+            }
+            /// No Copy
+            Logger(Logger const&) = delete;
+            Logger& operator=(Logger const&) = delete;
+            /// No Move
+            Logger(Logger&&) = delete;
+            Logger& operator=(Logger&&) = delete;
+
+            void push(Record&& record) noexcept {
+                if (!ring_.push(std::move(record))) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                pushed_.fetch_add(1, std::memory_order_release);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (sleeping_.load(std::memory_order_relaxed))
+                    wake();
+            }
+
+            bool allow(std::source_location const& location) noexcept {
+                auto const limit = rate_limit_.load(std::memory_order_relaxed);
+                if (limit == 0)
+                    return true;
+
+                auto const key = std::hash<std::string_view>{}(location.file_name()) ^ (location.line() * 0x9e3779b97f4a7c15ULL);
+                auto& slot = rates_[key & (RATE_SLOTS - 1)];
+                auto const now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+                // A new second opens a new window, the report of the previous one is logged once.
+                if (auto second = slot.second.load(std::memory_order_relaxed);
+                    second != now && slot.second.compare_exchange_strong(second, now, std::memory_order_relaxed)) {
+                    slot.count.store(0, std::memory_order_relaxed);
+                    if (auto const n = slot.suppressed.exchange(0, std::memory_order_relaxed))
+                        push(Record{std::chrono::system_clock::now(), location,
+                                    std::format("{} records suppressed from {}:{}", n, location.file_name(), location.line()),
+                                    WARNING});
+                }
+                if (slot.count.fetch_add(1, std::memory_order_relaxed) < limit)
+                    return true;
+                slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+                suppressed_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            void set_rate_limit(uint const per_second) noexcept {
+                rate_limit_.store(per_second, std::memory_order_relaxed);
+            }
+
+            void set_sink(std::shared_ptr<Sink> sink) {
+                if (!sink)
+                    sink = std::make_shared<StderrSink>();
+                std::lock_guard lock{sink_mutex_};
+                sink_ = std::move(sink);
+            }
+
+            void flush() noexcept {
+                auto const target = pushed_.load(std::memory_order_acquire);
+                wake();
+                for (auto done = written_.load(std::memory_order_acquire); done < target; done = written_.load(std::memory_order_acquire))
+                    written_.wait(done, std::memory_order_acquire);
+            }
+
+            Stats stats() const noexcept {
+                return {
+                    .written = written_.load(std::memory_order_relaxed),
+                    .dropped = dropped_.load(std::memory_order_relaxed),
+                    .suppressed = suppressed_.load(std::memory_order_relaxed)
+                };
+            }
+
+        private:
+            void wake() noexcept {
+                sleeping_.store(false, std::memory_order_relaxed);
+                sleeping_.notify_one();
+            }
+
+            /// Write everything from the ring buffer, the sink is flushed once per batch.
+            void drain() {
+                Record record{};
+                if (!ring_.pop(record))
+                    return;
+                std::shared_ptr<Sink> sink;
+                {
+                    std::lock_guard lock{sink_mutex_};
+                    sink = sink_;
+                }
+                do {
+                    try {
+                        sink->write(record);
+                    }
+                    catch (...) {
+                        // a failing sink must not stop the logger
+                    }
+                    written_.fetch_add(1, std::memory_order_release);
+                } while (ring_.pop(record));
+                try {
+                    sink->flush();
+                }
+                catch (...) {}
+                written_.notify_all();
+            }
+
+            void run() {
+                for (;;) {
+                    drain();
+                    if (stop_.load()) {
+                        drain();
+                        return;
+                    }
+                    // Sleep until a producer sees the flag (the fences pair with the one in push).
+                    sleeping_.store(true, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (!ring_.empty() || stop_.load()) {
+                        sleeping_.store(false, std::memory_order_relaxed);
+                        continue;
+                    }
+                    sleeping_.wait(true);
+                }
+            }
+        };
+    }
+
+    namespace detail {
+        bool allow(std::source_location const& location) noexcept {
+            if (shutdown.load(std::memory_order_relaxed))
+                return true;
+            return Logger::self().allow(location);
+        }
+
+        void write(Level const level, std::source_location const& location, std::string message) noexcept {
+            Record record{std::chrono::system_clock::now(), location, std::move(message), level};
+            if (shutdown.load(std::memory_order_relaxed)) {
+                // Logged from a static destructor, the flusher is gone.
+                try {
+                    auto const line = format(record);
+                    std::fwrite(line.data(), 1, line.size(), stderr);
+                }
+                catch (...) {}
+                return;
+            }
+            Logger::self().push(std::move(record));
+        }
+    }
+
+    void set_sink(std::shared_ptr<Sink> sink) {
+        Logger::self().set_sink(std::move(sink));
+    }
+
+    void set_rate_limit(uint const per_second) noexcept {
+        Logger::self().set_rate_limit(per_second);
+    }
+
+    void flush() noexcept {
+        if (!shutdown.load(std::memory_order_relaxed))
+            Logger::self().flush();
+    }
+
+    auto stats() noexcept
+    -> Stats {
+        return Logger::self().stats();
+    }
+
+    auto name(Level const level) noexcept
+    -> std::string_view {
+        switch (level) {
+            case DEBUG: return "DEBUG";
+            case INFO: return "INFO";
+            case WARNING: return "WARNING";
+            case ERROR: return "ERROR";
+            default: return "OFF";
+        }
+    }
+
+    auto format(Record const& record)
+    -> std::string {
+        auto const since_epoch = record.time.time_since_epoch();
+        auto const time = std::chrono::system_clock::to_time_t(record.time);
+        auto const ms = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch).count() % 1000;
+        std::tm tm{};
+        localtime_r(&time, &tm);
+        return std::format("{:04}-{:02}-{:02} {:02}:{:02}:{:02}.{:03} {} {}\n",
+                           tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                           tm.tm_hour, tm.tm_min, tm.tm_sec, ms,
+                           name(record.level), record.message);
+    }
+
+    /****************************************************************
+    *                                                               *
+    *                           S I N K S                           *
+    *                                                               *
+    ****************************************************************/
+
+    void StderrSink::
+    write(Record const& record) {
+        auto const line = format(record);
+        std::fwrite(line.data(), 1, line.size(), stderr);
+    }
+
+    void StderrSink::
+    flush() {
+        std::fflush(stderr);
+    }
+
+    FileSink::
+    FileSink(fs::path const& path)
+        : file_{path, std::ios::app} {}
+
+    void FileSink::
+    write(Record const& record) {
+        if (file_)
+            file_ << format(record);
+    }
+
+    void FileSink::
+    flush() {
+        file_.flush();
+    }
+}
@@ -26,17 +26,163 @@
 
 /*------- include files:
 -------------------------------------------------------------------*/
-#include <sqlite3.h>
-#include <source_location>
-#include <iostream>
+#include "types.h"
+#include "metrics.h"
+#include <atomic>
+#include <chrono>
+#include <concepts>
 #include <format>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <sqlite3.h>
+
+/// Asynchronous logger. \n
+/// Records are formatted on the calling thread, pushed to a lock-free ring buffer
+/// and written to the sink by a background thread, so the caller never waits for I/O.
+/// When the buffer is full the record is dropped (and counted).
+namespace logger {
+    enum Level : u8 {
+        DEBUG,
+        INFO,
+        WARNING,
+        ERROR,
+        OFF
+    };
+
+    struct Record {
+        std::chrono::system_clock::time_point time{};
+        std::source_location location{};
+        std::string message{};
+        Level level{};
+    };
+
+    /// Destination of records, called only from the flusher thread.
+    class Sink {
+    public:
+        virtual ~Sink() = default;
+        virtual void write(Record const& record) = 0;
+        /// Called after every batch of records.
+        virtual void flush() {}
+    };
+
+    /// Writes to stderr (the default sink).
+    class StderrSink final : public Sink {
+    public:
+        void write(Record const& record) override;
+        void flush() override;
+    };
+
+    /// Appends to the file.
+    class FileSink final : public Sink {
+        std::ofstream file_;
+    public:
+        explicit FileSink(fs::path const& path);
+        [[nodiscard]] bool is_open() const noexcept { return file_.is_open(); }
+        void write(Record const& record) override;
+        void flush() override;
+    };
+
+    /// Passes every record to the function.
+    class CallbackSink final : public Sink {
+        std::function<void(Record const&)> fn_;
+    public:
+        explicit CallbackSink(std::function<void(Record const&)> fn) : fn_{std::move(fn)} {}
+        void write(Record const& record) override {
+            if (fn_) fn_(record);
+        }
+    };
+
+    /// Discards everything.
+    class NullSink final : public Sink {
+    public:
+        void write(Record const&) override {}
+    };
+
+    struct Stats {
+        u64 written{};      // passed to the sink
+        u64 dropped{};      // the ring buffer was full
+        u64 suppressed{};   // rejected by the rate limit
+    };
+
+    /// Format string with the place of the call (the key of the rate limit). \n
+    /// The format string is checked against the arguments at compile time.
+    template<typename... Args>
+    struct Site {
+        std::format_string<Args...> format;
+        std::source_location location;
+        template<typename T> requires std::convertible_to<T const&, std::string_view>
+        consteval Site(T const& fmt, std::source_location const sl = std::source_location::current()) noexcept
+            : format{fmt}, location{sl} {}
+    };
+
+    namespace detail {
+        inline std::atomic<Level> level{INFO};
+        /// Rate limit of the call site, false if the record must be suppressed.
+        bool allow(std::source_location const& location) noexcept;
+        void write(Level level, std::source_location const& location, std::string message) noexcept;
+    }
+
+    [[nodiscard]] inline bool enabled(Level const level) noexcept {
+        return level >= detail::level.load(std::memory_order_relaxed);
+    }
+    inline void set_level(Level const level) noexcept {
+        detail::level.store(level, std::memory_order_relaxed);
+    }
+
+    /// Replace the sink (nullptr restores stderr).
+    void set_sink(std::shared_ptr<Sink> sink);
+    /// Records per second allowed for one call site (0 - no limit, the default is 10).
+    void set_rate_limit(uint per_second) noexcept;
+    /// Wait until records logged so far are written.
+    void flush() noexcept;
+    Stats stats() noexcept;
+    std::string_view name(Level level) noexcept;
+    /// Line written by the text sinks: 'date time.ms LEVEL message'.
+    std::string format(Record const& record);
+
+    /// Log the record of the place 'location' (the format string is checked at compile time).
+    template<typename... Args>
+    void log_at(Level const level, std::source_location const& location, std::format_string<Args...> const fmt, Args&&... args) noexcept {
+        if (!enabled(level) || !detail::allow(location))
+            return;
+        try {
+            detail::write(level, location, std::format(fmt, std::forward<Args>(args)...));
+        }
+        catch (...) {
+            // no memory for the message, nothing to log
+        }
+    }
+
+    template<typename... Args>
+    void log(Level const level, Site<std::type_identity_t<Args>...> const site, Args&&... args) noexcept {
+        log_at<Args...>(level, site.location, site.format, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void debug(Site<std::type_identity_t<Args>...> const site, Args&&... args) noexcept { log(DEBUG, site, std::forward<Args>(args)...); }
+    template<typename... Args>
+    void info(Site<std::type_identity_t<Args>...> const site, Args&&... args) noexcept { log(INFO, site, std::forward<Args>(args)...); }
+    template<typename... Args>
+    void warning(Site<std::type_identity_t<Args>...> const site, Args&&... args) noexcept { log(WARNING, site, std::forward<Args>(args)...); }
+    template<typename... Args>
+    void error(Site<std::type_identity_t<Args>...> const site, Args&&... args) noexcept { log(ERROR, site, std::forward<Args>(args)...); }
+}
 
 static inline void LOG_ERROR(sqlite3 *const db, std::source_location const sl = std::source_location::current()) noexcept {
-    if (auto const err = sqlite3_errcode(db); err != SQLITE_OK)
-        std::cerr << std::format("SQLite Error: {} ({}) => fn::{}().{} [{}]\n",
-                   sqlite3_errmsg(db),
-                   sqlite3_errcode(db),
-                   sl.function_name(),
-                   sl.line(),
-                   sl.file_name()) << std::flush;
+    if (auto const err = sqlite3_errcode(db); err != SQLITE_OK) {
+        metrics::add(metrics::ERRORS);
+        logger::log_at(logger::ERROR, sl, "SQLite Error: {} ({}) => fn::{}().{} [{}]",
+                    sqlite3_errmsg(db),
+                    err,
+                    sl.function_name(),
+                    sl.line(),
+                    sl.file_name());
+    }
 }
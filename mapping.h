@@ -0,0 +1,263 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include "value.h"
+#include "query.h"
+#include "stmt.h"
+#include "stmt_cache.h"
+#include "logger.h"
+#include "metrics.h"
+#include <concepts>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <sqlite3.h>
+
+/// Mapping of query results and arguments to aggregate structs and tuples. \n
+/// Columns are mapped to members by position (the first column to the first member, and so on),
+/// which is resolved at compile time. Cells are read with sqlite3_column_* straight into members,
+/// without Value, Field or Row. Unsupported member types do not compile.
+namespace mapping {
+    static constexpr size_t MAX_FIELDS = 24;
+
+    template<typename T> struct is_optional : std::false_type {};
+    template<typename T> struct is_optional<std::optional<T>> : std::true_type {};
+    template<typename T> struct is_tuple : std::false_type {};
+    template<typename... T> struct is_tuple<std::tuple<T...>> : std::true_type {};
+
+    /// Type convertible to any member type, used only to count members of an aggregate.
+    /// Conversion to std::optional is left to the optional's converting constructor.
+    struct any {
+        template<typename T> requires (!is_optional<T>::value)
+        constexpr operator T() const noexcept;
+    };
+
+    template<typename T, typename... A>
+    consteval size_t count_fields() {
+        if constexpr (sizeof...(A) <= MAX_FIELDS && requires { T{std::declval<A>()..., any{}}; })
+            return count_fields<T, A..., any>();
+        else
+            return sizeof...(A);
+    }
+
+    /// Struct (aggregate) or tuple which can be mapped to a row.
+    template<typename T>
+    concept Record = is_tuple<T>::value
+        || (std::is_aggregate_v<T> && std::is_class_v<T> && std::is_default_constructible_v<T>);
+
+    /// Number of members (columns) of the record.
+    template<Record T>
+    consteval size_t field_count() {
+        if constexpr (is_tuple<T>::value)
+            return std::tuple_size_v<T>;
+        else
+            return count_fields<T>();
+    }
+
+    /// Tuple of references to the members of the aggregate.
+    template<typename T>
+    constexpr auto aggregate_members(T& obj) noexcept {
+        constexpr auto n = field_count<std::remove_const_t<T>>();
+        static_assert(n > 0 && n <= MAX_FIELDS, "unsupported number of struct members");
+        if constexpr (n == 1) { auto& [m1] = obj; return std::tie(m1); }
+        else if constexpr (n == 2) { auto& [m1, m2] = obj; return std::tie(m1, m2); }
+        else if constexpr (n == 3) { auto& [m1, m2, m3] = obj; return std::tie(m1, m2, m3); }
+        else if constexpr (n == 4) { auto& [m1, m2, m3, m4] = obj; return std::tie(m1, m2, m3, m4); }
+        else if constexpr (n == 5) { auto& [m1, m2, m3, m4, m5] = obj; return std::tie(m1, m2, m3, m4, m5); }
+        else if constexpr (n == 6) { auto& [m1, m2, m3, m4, m5, m6] = obj; return std::tie(m1, m2, m3, m4, m5, m6); }
+        else if constexpr (n == 7) { auto& [m1, m2, m3, m4, m5, m6, m7] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7); }
+        else if constexpr (n == 8) { auto& [m1, m2, m3, m4, m5, m6, m7, m8] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8); }
+        else if constexpr (n == 9) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9); }
+        else if constexpr (n == 10) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10); }
+        else if constexpr (n == 11) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11); }
+        else if constexpr (n == 12) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12); }
+        else if constexpr (n == 13) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13); }
+        else if constexpr (n == 14) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14); }
+        else if constexpr (n == 15) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15); }
+        else if constexpr (n == 16) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16); }
+        else if constexpr (n == 17) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17); }
+        else if constexpr (n == 18) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18); }
+        else if constexpr (n == 19) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19); }
+        else if constexpr (n == 20) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20); }
+        else if constexpr (n == 21) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20, m21] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20, m21); }
+        else if constexpr (n == 22) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20, m21, m22] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20, m21, m22); }
+        else if constexpr (n == 23) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20, m21, m22, m23] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20, m21, m22, m23); }
+        else if constexpr (n == 24) { auto& [m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20, m21, m22, m23, m24] = obj; return std::tie(m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20, m21, m22, m23, m24); }
+    }
+
+    /// Tuple of references to the members of the record.
+    template<typename T> requires Record<std::remove_const_t<T>>
+    constexpr auto members(T& obj) noexcept {
+        if constexpr (is_tuple<std::remove_const_t<T>>::value)
+            return std::apply([](auto&... m) { return std::tie(m...); }, obj);
+        else
+            return aggregate_members(obj);
+    }
+
+    /****************************************************************
+    *                                                               *
+    *                            R E A D                            *
+    *                                                               *
+    ****************************************************************/
+
+    /// Read the cell of the current row to the member.
+    template<typename T>
+    void read(sqlite3_stmt* const stmt, int const idx, T& out) noexcept {
+        if constexpr (std::same_as<T, bool>)
+            out = sqlite3_column_int64(stmt, idx) != 0;
+        else if constexpr (std::integral<T>)
+            out = static_cast<T>(sqlite3_column_int64(stmt, idx));
+        else if constexpr (std::floating_point<T>)
+            out = static_cast<T>(sqlite3_column_double(stmt, idx));
+        else if constexpr (std::same_as<T, std::string>) {
+            auto const ptr = reinterpret_cast<char const*>(sqlite3_column_text(stmt, idx));
+            out.assign(ptr ? ptr : "", static_cast<size_t>(sqlite3_column_bytes(stmt, idx)));
+        }
+        else if constexpr (std::same_as<T, std::vector<u8>>) {
+            auto const ptr = static_cast<u8 const*>(sqlite3_column_blob(stmt, idx));
+            out.assign(ptr, ptr + sqlite3_column_bytes(stmt, idx));
+        }
+        else if constexpr (is_optional<T>::value) {
+            if (sqlite3_column_type(stmt, idx) == SQLITE_NULL)
+                out.reset();
+            else
+                read(stmt, idx, out.emplace());
+        }
+        else if constexpr (std::same_as<T, Value>)
+            out = RowView{stmt}.value(idx);
+        else
+            static_assert(false && sizeof(T), "unsupported member type (use integral, floating point, std::string, std::vector<u8>, Value or std::optional of them)");
+    }
+
+    /// Read the current row to the record.
+    template<Record T>
+    void read_row(sqlite3_stmt* const stmt, T& obj) noexcept {
+        std::apply([stmt](auto&... m) {
+            auto idx = 0;
+            (..., read(stmt, idx++, m));
+        }, members(obj));
+    }
+
+    /****************************************************************
+    *                                                               *
+    *                            B I N D                            *
+    *                                                               *
+    ****************************************************************/
+
+    /// Bind the member to the placeholder (text and blobs are not copied).
+    template<typename T>
+    bool bind(sqlite3_stmt* const stmt, int const idx, T const& v) noexcept {
+        if constexpr (std::integral<T>)
+            return SQLITE_OK == sqlite3_bind_int64(stmt, idx, static_cast<sqlite3_int64>(v));
+        else if constexpr (std::floating_point<T>)
+            return SQLITE_OK == sqlite3_bind_double(stmt, idx, static_cast<f64>(v));
+        else if constexpr (std::convertible_to<T const&, std::string_view>)
+            return bind_at(stmt, idx, std::string_view{v});
+        else if constexpr (std::same_as<T, std::vector<u8>> || std::same_as<T, std::span<const u8>>)
+            return bind_at(stmt, idx, std::span<const u8>{v});
+        else if constexpr (std::same_as<T, std::nullptr_t> || std::same_as<T, std::nullopt_t>)
+            return SQLITE_OK == sqlite3_bind_null(stmt, idx);
+        else if constexpr (is_optional<T>::value)
+            return v ? bind(stmt, idx, *v) : SQLITE_OK == sqlite3_bind_null(stmt, idx);
+        else if constexpr (std::same_as<T, Value>)
+            return bind_at(stmt, idx, v);
+        else
+            static_assert(false && sizeof(T), "unsupported argument type (use integral, floating point, text, std::vector<u8>, Value or std::optional of them)");
+    }
+
+    /// Bind all members of the record to placeholders 1...N.
+    template<Record T>
+    bool bind_row(sqlite3_stmt* const stmt, T const& obj) noexcept {
+        return std::apply([stmt](auto const&... m) {
+            auto idx = 0;
+            return (... && bind(stmt, ++idx, m));
+        }, members(obj));
+    }
+
+    /****************************************************************
+    *                                                               *
+    *                   S E L E C T  /  I N S E R T                 *
+    *                                                               *
+    ****************************************************************/
+
+    /// Execute the query and read every row to a record.
+    template<Record T>
+    std::optional<std::vector<T>> select_as(sqlite3* const db, StmtCache* const cache, Query const& query) {
+        if (!query.valid())
+            return {};
+        auto const stmt = cache->acquire(db, query.cmd());
+        if (!stmt)
+            return {};
+
+        constexpr auto n = static_cast<int>(field_count<T>());
+        std::vector<T> result{};
+        auto ok = bind2stmt(stmt, query.values());
+        if (ok && sqlite3_column_count(stmt) != n) {
+            logger::error("The number of columns and members does not match ({}, {})", sqlite3_column_count(stmt), n);
+            ok = false;
+        }
+        if (ok) {
+            int rc;
+            while (SQLITE_ROW == (rc = metrics::step(stmt))) {
+                read_row(stmt, result.emplace_back());
+            }
+            if (rc != SQLITE_DONE) {
+                LOG_ERROR(db);
+                ok = false;
+            }
+        }
+        cache->release(query.cmd(), stmt);
+        if (ok)
+            return std::move(result);
+        return {};
+    }
+
+    /// Bind the members of the record to the query placeholders and execute it.
+    /// Returns the rowid of the inserted row.
+    template<Record T>
+    i64 insert(sqlite3* const db, StmtCache* const cache, std::string const& query_str, T const& obj, i64 const invalid_rowid) {
+        auto const stmt = cache->acquire(db, query_str);
+        if (!stmt)
+            return invalid_rowid;
+
+        constexpr auto n = static_cast<int>(field_count<T>());
+        auto rowid = invalid_rowid;
+        if (sqlite3_bind_parameter_count(stmt) != n)
+            logger::error("The number of placeholders and members does not match ({}, {})", sqlite3_bind_parameter_count(stmt), n);
+        else if (bind_row(stmt, obj) && SQLITE_DONE == metrics::step(stmt))
+            rowid = sqlite3_last_insert_rowid(db);
+        else
+            LOG_ERROR(db);
+        cache->release(query_str, stmt);
+        return rowid;
+    }
+}
@@ -0,0 +1,480 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "metrics.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <format>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <unordered_map>
+
+namespace metrics {
+    namespace {
+        constexpr size_t MAX_QUERIES_PER_THREAD{1024};  // distinct fingerprints
+        constexpr size_t MAX_CACHED_SQL{4096};          // raw SQL texts mapped to fingerprints
+        constexpr std::array QUANTILES{0.5, 0.9, 0.99, 0.999};
+        constexpr std::array QUANTILE_KEYS{"p50", "p90", "p99", "p999"};
+
+        /// Histogram written by exactly one thread (relaxed load + store, no RMW)
+        /// and read concurrently by snapshot().
+        struct AtomicHistogram {
+            std::array<std::atomic<u64>, Histogram::BUCKETS> buckets{};
+            std::atomic<u64> count{};
+            std::atomic<u64> sum{};
+            std::atomic<u64> min{std::numeric_limits<u64>::max()};
+            std::atomic<u64> max{};
+
+            static void bump(std::atomic<u64>& a, u64 const n) noexcept {
+                a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+
+            void record(u64 const ns) noexcept {
+                bump(buckets[Histogram::index(ns)], 1);
+                bump(count, 1);
+                bump(sum, ns);
+                if (ns < min.load(std::memory_order_relaxed)) min.store(ns, std::memory_order_relaxed);
+                if (ns > max.load(std::memory_order_relaxed)) max.store(ns, std::memory_order_relaxed);
+            }
+
+            void merge_into(Histogram& h) const noexcept {
+                Histogram part{};
+                for (uint i = 0; i < Histogram::BUCKETS; ++i)
+                    part.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+                part.count = count.load(std::memory_order_relaxed);
+                part.sum = sum.load(std::memory_order_relaxed);
+                part.min = min.load(std::memory_order_relaxed);
+                part.max = max.load(std::memory_order_relaxed);
+                h.merge(part);
+            }
+        };
+
+        struct QueryEntry {
+            std::string fingerprint;
+            AtomicHistogram latency;
+        };
+
+        /// Metrics of one thread.
+        struct Shard {
+            std::array<std::atomic<u64>, COUNTERS> counters{};
+            std::array<AtomicHistogram, OPERATIONS> operations{};
+            std::mutex mutex;   // guards the structure of 'queries' (not the histograms)
+            std::unordered_map<std::string, std::unique_ptr<QueryEntry>> queries;
+        };
+
+        class Registry {
+            std::mutex mutex_;
+            std::vector<std::shared_ptr<Shard>> shards_;
+        public:
+            static Registry& self() {
+                static Registry registry;
+                return registry;
+            }
+            std::shared_ptr<Shard> attach() {
+                auto shard = std::make_shared<Shard>();
+                std::lock_guard lock{mutex_};
+                shards_.push_back(shard);
+                return shard;
+            }
+            /// Shards of finished threads stay registered, so the totals never go back.
+            std::vector<std::shared_ptr<Shard>> shards() {
+                std::lock_guard lock{mutex_};
+                return shards_;
+            }
+        };
+
+        Shard& local_shard() {
+            thread_local std::shared_ptr<Shard> const shard = Registry::self().attach();
+            return *shard;
+        }
+
+        struct StringHash {
+            using is_transparent = void;
+            size_t operator()(std::string_view const text) const noexcept {
+                return std::hash<std::string_view>{}(text);
+            }
+        };
+
+        /// Entry for the SQL (nullptr if the thread reached the limit of fingerprints).
+        QueryEntry* query_entry(Shard& shard, std::string_view const sql) {
+            thread_local std::unordered_map<std::string, QueryEntry*, StringHash, std::equal_to<>> cache;
+            if (auto const it = cache.find(sql); it != cache.end())
+                return it->second;
+
+            auto fp = fingerprint(sql);
+            QueryEntry* entry{};
+            {
+                std::lock_guard lock{shard.mutex};
+                if (auto const it = shard.queries.find(fp); it != shard.queries.end())
+                    entry = it->second.get();
+                else if (shard.queries.size() < MAX_QUERIES_PER_THREAD) {
+                    auto e = std::make_unique<QueryEntry>();
+                    e->fingerprint = fp;
+                    entry = e.get();
+                    shard.queries.emplace(std::move(fp), std::move(e));
+                }
+            }
+            if (cache.size() >= MAX_CACHED_SQL)
+                cache.clear();
+            cache.emplace(std::string{sql}, entry);
+            return entry;
+        }
+
+        bool is_identifier_char(char const c) noexcept {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+        }
+
+        std::string escape_json(std::string_view const text) {
+            std::string out;
+            out.reserve(text.size() + 2);
+            for (auto const c: text) {
+                switch (c) {
+                    case '"': out += "\\\""; break;
+                    case '\\': out += "\\\\"; break;
+                    case '\n': out += "\\n"; break;
+                    case '\r': out += "\\r"; break;
+                    case '\t': out += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20)
+                            out += std::format("\\u{:04x}", static_cast<int>(c));
+                        else
+                            out += c;
+                }
+            }
+            return out;
+        }
+
+        std::string escape_label(std::string_view const text) {
+            std::string out;
+            out.reserve(text.size());
+            for (auto const c: text) {
+                switch (c) {
+                    case '"': out += "\\\""; break;
+                    case '\\': out += "\\\\"; break;
+                    case '\n': out += "\\n"; break;
+                    default: out += c;
+                }
+            }
+            return out;
+        }
+
+        double seconds(u64 const ns) noexcept {
+            return static_cast<double>(ns) / 1e9;
+        }
+
+        void prometheus_summary(std::string& out, std::string_view const metric, std::string const& labels, Histogram const& h) {
+            for (auto const q: QUANTILES)
+                out += std::format("{}{{{},quantile=\"{}\"}} {}\n", metric, labels, q, seconds(h.quantile(q)));
+            out += std::format("{}_sum{{{}}} {}\n", metric, labels, seconds(h.sum));
+            out += std::format("{}_count{{{}}} {}\n", metric, labels, h.count);
+        }
+
+        std::string json_histogram(Histogram const& h) {
+            auto out = std::format(R"("count":{},"sum_ns":{},"min_ns":{},"max_ns":{})", h.count, h.sum, h.min, h.max);
+            for (size_t i = 0; i < QUANTILES.size(); ++i)
+                out += std::format(R"(,"{}_ns":{})", QUANTILE_KEYS[i], h.quantile(QUANTILES[i]));
+            return out;
+        }
+    }
+
+    namespace detail {
+        void add(Counter const counter, u64 const n) noexcept {
+            AtomicHistogram::bump(local_shard().counters[counter], n);
+        }
+
+        void record(Operation const op, std::string_view const sql, u64 const ns) noexcept {
+            auto& shard = local_shard();
+            shard.operations[op].record(ns);
+            if (sql.empty())
+                return;
+            try {
+                if (auto const entry = query_entry(shard, sql))
+                    entry->latency.record(ns);
+            }
+            catch (...) {
+                // metrics never break the caller
+            }
+        }
+    }
+
+    /****************************************************************
+    *                                                               *
+    *                      H I S T O G R A M                        *
+    *                                                               *
+    ****************************************************************/
+
+    auto Histogram::
+    index(u64 const ns) noexcept
+    -> uint {
+        if (ns < SUB_BUCKETS)
+            return static_cast<uint>(ns);
+        auto const exponent = static_cast<uint>(std::bit_width(ns)) - 1;   // >= 4
+        auto const sub = static_cast<uint>(ns >> (exponent - 4)) & (SUB_BUCKETS - 1);
+        return (exponent - 3) * SUB_BUCKETS + sub;
+    }
+
+    auto Histogram::
+    upper_bound(uint const index) noexcept
+    -> u64 {
+        if (index < SUB_BUCKETS)
+            return index;
+        auto const exponent = index / SUB_BUCKETS + 3;
+        auto const sub = index % SUB_BUCKETS;
+        auto const lower = (u64{SUB_BUCKETS} + sub) << (exponent - 4);
+        return lower + ((u64{1} << (exponent - 4)) - 1);
+    }
+
+    auto Histogram::
+    quantile(double const q) const noexcept
+    -> u64 {
+        if (count == 0)
+            return 0;
+        auto const target = std::max<u64>(1, static_cast<u64>(std::ceil(q * static_cast<double>(count))));
+        u64 seen{};
+        for (uint i = 0; i < BUCKETS; ++i) {
+            seen += buckets[i];
+            if (seen >= target)
+                return std::clamp(upper_bound(i), min, max);
+        }
+        return max;
+    }
+
+    void Histogram::
+    merge(Histogram const& other) noexcept {
+        if (other.count == 0)
+            return;
+        for (uint i = 0; i < BUCKETS; ++i)
+            buckets[i] += other.buckets[i];
+        min = count ? std::min(min, other.min) : other.min;
+        max = std::max(max, other.max);
+        count += other.count;
+        sum += other.sum;
+    }
+
+    /****************************************************************
+    *                                                               *
+    *                       S N A P S H O T                         *
+    *                                                               *
+    ****************************************************************/
+
+    auto snapshot()
+    -> Snapshot {
+        Snapshot snap{};
+        std::map<std::string, Histogram> queries;
+
+        for (auto const& shard: Registry::self().shards()) {
+            for (uint i = 0; i < COUNTERS; ++i)
+                snap.counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+            for (uint i = 0; i < OPERATIONS; ++i)
+                shard->operations[i].merge_into(snap.operations[i]);
+
+            std::lock_guard lock{shard->mutex};
+            for (auto const& [fp, entry]: shard->queries)
+                entry->latency.merge_into(queries[fp]);
+        }
+
+        snap.queries.reserve(queries.size());
+        for (auto& [fp, h]: queries)
+            if (h.count)
+                snap.queries.push_back({fp, std::move(h)});
+        return snap;
+    }
+
+    auto Snapshot::
+    to_prometheus() const
+    -> std::string {
+        std::string out;
+        for (uint i = 0; i < COUNTERS; ++i) {
+            auto const metric = std::format("sqlite_{}_total", name(static_cast<Counter>(i)));
+            out += std::format("# TYPE {} counter\n{} {}\n", metric, metric, counters[i]);
+        }
+
+        out += "# TYPE sqlite_operation_duration_seconds summary\n";
+        for (uint i = 0; i < OPERATIONS; ++i)
+            if (operations[i].count)
+                prometheus_summary(out, "sqlite_operation_duration_seconds",
+                                   std::format("operation=\"{}\"", name(static_cast<Operation>(i))), operations[i]);
+
+        out += "# TYPE sqlite_query_duration_seconds summary\n";
+        for (auto const& q: queries)
+            prometheus_summary(out, "sqlite_query_duration_seconds",
+                               std::format("query=\"{}\"", escape_label(q.fingerprint)), q.latency);
+        return out;
+    }
+
+    auto Snapshot::
+    to_json() const
+    -> std::string {
+        std::string out{R"({"counters":{)"};
+        for (uint i = 0; i < COUNTERS; ++i)
+            out += std::format(R"({}"{}":{})", i ? "," : "", name(static_cast<Counter>(i)), counters[i]);
+
+        out += R"(},"operations":{)";
+        bool first{true};
+        for (uint i = 0; i < OPERATIONS; ++i) {
+            if (operations[i].count == 0) continue;
+            out += std::format(R"({}"{}":{{{}}})", first ? "" : ",", name(static_cast<Operation>(i)), json_histogram(operations[i]));
+            first = false;
+        }
+
+        out += R"(},"queries":[)";
+        first = true;
+        for (auto const& q: queries) {
+            out += std::format(R"({}{{"fingerprint":"{}",{}}})", first ? "" : ",", escape_json(q.fingerprint), json_histogram(q.latency));
+            first = false;
+        }
+        out += "]}";
+        return out;
+    }
+
+    /****************************************************************
+    *                                                               *
+    *                    F I N G E R P R I N T                      *
+    *                                                               *
+    ****************************************************************/
+
+    /// Literals, numbers and named parameters become '?', comments are dropped,
+    /// whitespace is squeezed, keywords and identifiers are upper-cased (quoted ones are kept),
+    /// lists of placeholders ("IN (?, ?, ?)", "VALUES (?, ?), (?, ?)") collapse to '...'.
+    auto fingerprint(std::string_view const sql)
+    -> std::string {
+        std::string out;
+        out.reserve(sql.size());
+        auto const n = sql.size();
+
+        auto space = [&out] {
+            if (!out.empty() && out.back() != ' ')
+                out += ' ';
+        };
+        auto skip_quoted = [&](size_t i, char const close) {    // i at the opening char, returns the position after closing
+            for (++i; i < n; ++i)
+                if (sql[i] == close) {
+                    if (close == '\'' && i + 1 < n && sql[i + 1] == '\'') { ++i; continue; }
+                    return i + 1;
+                }
+            return n;
+        };
+
+        for (size_t i = 0; i < n;) {
+            auto const c = sql[i];
+            auto const next = i + 1 < n ? sql[i + 1] : '\0';
+            auto const prev_ident = !out.empty() && is_identifier_char(out.back());
+
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                space();
+                ++i;
+            }
+            else if (c == '-' && next == '-') {
+                while (i < n && sql[i] != '\n') ++i;
+                space();
+            }
+            else if (c == '/' && next == '*') {
+                auto const end = sql.find("*/", i + 2);
+                i = end == std::string_view::npos ? n : end + 2;
+                space();
+            }
+            else if (c == '\'') {
+                out += '?';
+                i = skip_quoted(i, '\'');
+            }
+            else if ((c == 'x' || c == 'X') && next == '\'' && !prev_ident) {
+                out += '?';
+                i = skip_quoted(i + 1, '\'');
+            }
+            else if (c == '"' || c == '`' || c == '[') {
+                auto const end = skip_quoted(i, c == '[' ? ']' : c);
+                out.append(sql.substr(i, end - i));
+                i = end;
+            }
+            else if (!prev_ident && (std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && std::isdigit(static_cast<unsigned char>(next))))) {
+                ++i;
+                while (i < n) {
+                    auto const d = sql[i];
+                    if (std::isalnum(static_cast<unsigned char>(d)) || d == '.')
+                        ++i;
+                    else if ((d == '+' || d == '-') && (sql[i - 1] == 'e' || sql[i - 1] == 'E'))
+                        ++i;
+                    else
+                        break;
+                }
+                out += '?';
+            }
+            else if (c == '?' || ((c == ':' || c == '@' || c == '$') && is_identifier_char(next))) {
+                ++i;
+                while (i < n && is_identifier_char(sql[i])) ++i;
+                out += '?';
+            }
+            else {
+                out += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                ++i;
+            }
+        }
+
+        while (!out.empty() && (out.back() == ' ' || out.back() == ';'))
+            out.pop_back();
+
+        static std::regex const placeholders{R"(\? ?, ?\?( ?, ?\?)*)"};
+        static std::regex const tuples{R"(\((\.\.\.|\?)\)( ?, ?\((\.\.\.|\?)\))+)"};
+        out = std::regex_replace(out, placeholders, "...");
+        out = std::regex_replace(out, tuples, "(...), ...");
+        return out;
+    }
+
+    auto name(Counter const counter) noexcept
+    -> std::string_view {
+        switch (counter) {
+            case PREPARES: return "prepares";
+            case STEPS: return "steps";
+            case FINALIZES: return "finalizes";
+            case ROWS_FETCHED: return "rows_fetched";
+            case BYTES_BOUND: return "bytes_bound";
+            case BYTES_SERIALIZED: return "bytes_serialized";
+            case BYTES_COMPRESSED: return "bytes_compressed";
+            case ERRORS: return "errors";
+            default: return "unknown";
+        }
+    }
+
+    auto name(Operation const op) noexcept
+    -> std::string_view {
+        switch (op) {
+            case PREPARE: return "prepare";
+            case EXEC: return "exec";
+            case SELECT: return "select";
+            case COMMIT: return "commit";
+            case SERIALIZE: return "serialize";
+            case COMPRESS: return "compress";
+            case DECOMPRESS: return "decompress";
+            default: return "unknown";
+        }
+    }
+}
@@ -0,0 +1,179 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sqlite3.h>
+
+/// Metrics of the library: counters and latency histograms (per operation and per query). \n
+/// Every thread writes to its own shard without locks, shards are merged by snapshot().
+/// The registry is disabled by default, then every probe is one relaxed atomic load.
+namespace metrics {
+    enum Counter : u8 {
+        PREPARES,
+        STEPS,
+        FINALIZES,
+        ROWS_FETCHED,
+        BYTES_BOUND,
+        BYTES_SERIALIZED,
+        BYTES_COMPRESSED,
+        ERRORS,
+        COUNTERS    // number of counters
+    };
+
+    enum Operation : u8 {
+        PREPARE,
+        EXEC,
+        SELECT,
+        COMMIT,
+        SERIALIZE,
+        COMPRESS,
+        DECOMPRESS,
+        OPERATIONS  // number of operations
+    };
+
+    namespace detail {
+        inline std::atomic<bool> enabled{false};
+        void add(Counter counter, u64 n) noexcept;
+        void record(Operation op, std::string_view sql, u64 ns) noexcept;
+    }
+
+    [[nodiscard]] inline bool enabled() noexcept {
+        return detail::enabled.load(std::memory_order_relaxed);
+    }
+    inline void enable(bool const on = true) noexcept {
+        detail::enabled.store(on, std::memory_order_relaxed);
+    }
+
+    inline void add(Counter const counter, u64 const n = 1) noexcept {
+        if (enabled())
+            detail::add(counter, n);
+    }
+
+    /// sqlite3_step counting steps and fetched rows.
+    inline int step(sqlite3_stmt* const stmt) noexcept {
+        auto const rc = sqlite3_step(stmt);
+        if (enabled()) {
+            detail::add(STEPS, 1);
+            if (rc == SQLITE_ROW)
+                detail::add(ROWS_FETCHED, 1);
+        }
+        return rc;
+    }
+
+    /// Measures the duration of the operation (from construction to destruction).
+    /// With the SQL the latency is recorded for its fingerprint too (the SQL must outlive the timer).
+    class Timer {
+        std::chrono::steady_clock::time_point start_{};
+        std::string_view sql_;
+        Operation op_;
+        bool active_;
+    public:
+        explicit Timer(Operation const op, std::string_view const sql = {}) noexcept
+            : sql_{sql}, op_{op}, active_{enabled()} {
+            if (active_)
+                start_ = std::chrono::steady_clock::now();
+        }
+        ~Timer() {
+            if (active_) {
+                auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+                detail::record(op_, sql_, static_cast<u64>(ns.count()));
+            }
+        }
+        /// No Copy
+        Timer(Timer const&) = delete;
+        Timer& operator=(Timer const&) = delete;
+        /// No Move
+        Timer(Timer&&) = delete;
+        Timer& operator=(Timer&&) = delete;
+    };
+
+    /// sqlite3_prepare_v3 counted and timed.
+    inline int prepare(sqlite3* const db, std::string_view const sql, uint const flags, sqlite3_stmt** const stmt) noexcept {
+        Timer timer{PREPARE};
+        add(PREPARES);
+        return sqlite3_prepare_v3(db, sql.data(), static_cast<int>(sql.size()), flags, stmt, nullptr);
+    }
+
+    /// sqlite3_finalize counted.
+    inline int finalize(sqlite3_stmt* const stmt) noexcept {
+        if (stmt)
+            add(FINALIZES);
+        return sqlite3_finalize(stmt);
+    }
+
+    /// Merged latency histogram (nanoseconds). \n
+    /// HDR-style log-linear buckets: 16 sub-buckets for every power of two (relative error below 6.25%).
+    struct Histogram {
+        static constexpr uint SUB_BUCKETS = 16;
+        static constexpr uint BUCKETS = (64 - 3) * SUB_BUCKETS;
+
+        std::vector<u64> buckets = std::vector<u64>(BUCKETS);
+        u64 count{};
+        u64 sum{};
+        u64 min{};
+        u64 max{};
+
+        static uint index(u64 ns) noexcept;
+        /// The highest value counted in the bucket.
+        static u64 upper_bound(uint index) noexcept;
+        /// Value at the quantile (0.0 - 1.0), i.e. the upper bound of its bucket.
+        [[nodiscard]] u64 quantile(double q) const noexcept;
+        void merge(Histogram const& other) noexcept;
+    };
+
+    struct QueryMetrics {
+        /// Normalized SQL: literals replaced by '?', lists of placeholders collapsed, whitespace squeezed.
+        std::string fingerprint;
+        Histogram latency;
+    };
+
+    struct Snapshot {
+        std::array<u64, COUNTERS> counters{};
+        std::array<Histogram, OPERATIONS> operations{};
+        std::vector<QueryMetrics> queries{};
+
+        /// Prometheus text exposition format (latencies as summaries in seconds).
+        [[nodiscard]] std::string to_prometheus() const;
+        [[nodiscard]] std::string to_json() const;
+    };
+
+    /// Merge the shards of all threads (the values are monotonic, nothing is reset).
+    Snapshot snapshot();
+
+    /// Normalize the SQL to its fingerprint.
+    std::string fingerprint(std::string_view sql);
+
+    std::string_view name(Counter counter) noexcept;
+    std::string_view name(Operation op) noexcept;
+}
@@ -0,0 +1,251 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "options.h"
+#include "logger.h"
+#include "metrics.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <format>
+
+namespace {
+    constexpr i64 MiB{1024 * 1024};
+
+    std::string_view name(OpenOptions::JournalMode const mode) noexcept {
+        using enum OpenOptions::JournalMode;
+        switch (mode) {
+            case DELETE: return "DELETE";
+            case TRUNCATE: return "TRUNCATE";
+            case PERSIST: return "PERSIST";
+            case MEMORY: return "MEMORY";
+            case WAL: return "WAL";
+            case OFF: return "OFF";
+            default: return {};
+        }
+    }
+
+    std::string_view name(OpenOptions::Synchronous const mode) noexcept {
+        using enum OpenOptions::Synchronous;
+        switch (mode) {
+            case OFF: return "OFF";
+            case NORMAL: return "NORMAL";
+            case FULL: return "FULL";
+            case EXTRA: return "EXTRA";
+            default: return {};
+        }
+    }
+
+    std::string_view name(OpenOptions::TempStore const store) noexcept {
+        using enum OpenOptions::TempStore;
+        switch (store) {
+            case FILE: return "FILE";
+            case MEMORY: return "MEMORY";
+            default: return {};
+        }
+    }
+
+    /// Text of the first column of the first row returned by the statement.
+    std::optional<std::string> pragma_value(sqlite3* const db, std::string const& sql) noexcept {
+        sqlite3_stmt* stmt{};
+        if (SQLITE_OK != metrics::prepare(db, sql, 0, &stmt))
+            return {};
+        std::optional<std::string> value{};
+        if (SQLITE_ROW == metrics::step(stmt))
+            if (auto const text = sqlite3_column_text(stmt, 0))
+                value = reinterpret_cast<char const*>(text);
+        metrics::finalize(stmt);
+        return value;
+    }
+
+    std::optional<i64> pragma_integer(sqlite3* const db, std::string const& sql) noexcept {
+        auto const text = pragma_value(db, sql);
+        if (!text)
+            return {};
+        i64 value{};
+        if (auto const [_, ec] = std::from_chars(text->data(), text->data() + text->size(), value); ec != std::errc{})
+            return {};
+        return value;
+    }
+
+    bool iequal(std::string_view const a, std::string_view const b) noexcept {
+        return std::ranges::equal(a, b, [](char const x, char const y) {
+            return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y));
+        });
+    }
+}
+
+/********************************************************************
+*                                                                   *
+*                           P R E S E T S                           *
+*                                                                   *
+********************************************************************/
+
+auto OpenOptions::
+read_heavy() noexcept
+-> OpenOptions {
+    return {
+        .threading = Threading::MULTI_THREAD,
+        .journal_mode = JournalMode::WAL,
+        .synchronous = Synchronous::NORMAL,
+        .temp_store = TempStore::MEMORY,
+        .cache_size = -64 * 1024,               // 64 MiB
+        .mmap_size = 1024 * MiB,
+        .busy_timeout = 5000
+    };
+}
+
+auto OpenOptions::
+write_heavy() noexcept
+-> OpenOptions {
+    return {
+        .threading = Threading::MULTI_THREAD,
+        .journal_mode = JournalMode::WAL,
+        .synchronous = Synchronous::NORMAL,
+        .temp_store = TempStore::MEMORY,
+        .cache_size = -64 * 1024,               // 64 MiB
+        .mmap_size = 256 * MiB,
+        .wal_autocheckpoint = 10'000,
+        .busy_timeout = 5000
+    };
+}
+
+auto OpenOptions::
+bulk_load() noexcept
+-> OpenOptions {
+    return {
+        .create = true,
+        .threading = Threading::MULTI_THREAD,
+        .journal_mode = JournalMode::OFF,
+        .synchronous = Synchronous::OFF,
+        .temp_store = TempStore::MEMORY,
+        .exclusive = true,
+        .cache_size = -256 * 1024,              // 256 MiB
+        .mmap_size = 0
+    };
+}
+
+/********************************************************************
+*                                                                   *
+*                             A P P L Y                             *
+*                                                                   *
+********************************************************************/
+
+auto OpenOptions::
+flags() const noexcept
+-> int {
+    auto flags = read_only ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE;
+    if (create && !read_only)
+        flags |= SQLITE_OPEN_CREATE;
+    if (threading == Threading::MULTI_THREAD)
+        flags |= SQLITE_OPEN_NOMUTEX;
+    else if (threading == Threading::SERIALIZED)
+        flags |= SQLITE_OPEN_FULLMUTEX;
+    return flags;
+}
+
+auto OpenOptions::
+pragmas() const
+-> std::vector<std::string> {
+    std::vector<std::string> pragmas{};
+    // The locking mode goes first, in exclusive mode WAL works without shared memory.
+    if (exclusive)
+        pragmas.emplace_back("PRAGMA locking_mode=EXCLUSIVE");
+    // The journal mode of a read-only connection can't be changed (it is only checked).
+    if (journal_mode != JournalMode::DEFAULT && !read_only)
+        pragmas.push_back(std::format("PRAGMA journal_mode={}", name(journal_mode)));
+    if (synchronous != Synchronous::DEFAULT)
+        pragmas.push_back(std::format("PRAGMA synchronous={}", name(synchronous)));
+    if (temp_store != TempStore::DEFAULT)
+        pragmas.push_back(std::format("PRAGMA temp_store={}", name(temp_store)));
+    if (cache_size)
+        pragmas.push_back(std::format("PRAGMA cache_size={}", *cache_size));
+    if (mmap_size)
+        pragmas.push_back(std::format("PRAGMA mmap_size={}", *mmap_size));
+    if (wal_autocheckpoint)
+        pragmas.push_back(std::format("PRAGMA wal_autocheckpoint={}", *wal_autocheckpoint));
+    return pragmas;
+}
+
+auto OpenOptions::
+apply(sqlite3* const db) const noexcept
+-> bool {
+    if (busy_timeout && SQLITE_OK != sqlite3_busy_timeout(db, *busy_timeout)) {
+        LOG_ERROR(db);
+        return {};
+    }
+    try {
+        for (auto const& pragma : pragmas())
+            if (SQLITE_OK != sqlite3_exec(db, pragma.c_str(), nullptr, nullptr, nullptr)) {
+                LOG_ERROR(db);
+                return {};
+            }
+    }
+    catch (...) {
+        return {};
+    }
+
+    // SQLite answers a journal mode it can't use with the current one (e.g. WAL for :memory:).
+    if (journal_mode != JournalMode::DEFAULT) {
+        auto const mode = pragma_value(db, "PRAGMA journal_mode");
+        if (!mode || !iequal(*mode, name(journal_mode))) {
+            logger::error("The journal mode {} was not accepted (it is {}).", name(journal_mode), mode.value_or("unknown"));
+            return {};
+        }
+    }
+    return true;
+}
+
+auto OpenOptions::
+effective(sqlite3* const db) noexcept
+-> std::optional<Effective> {
+    if (!db)
+        return {};
+    try {
+        Effective e{};
+        e.journal_mode = pragma_value(db, "PRAGMA journal_mode").value_or("");
+        e.locking_mode = pragma_value(db, "PRAGMA locking_mode").value_or("");
+        e.synchronous = pragma_integer(db, "PRAGMA synchronous").value_or(-1);
+        e.temp_store = pragma_integer(db, "PRAGMA temp_store").value_or(-1);
+        e.cache_size = pragma_integer(db, "PRAGMA cache_size").value_or(0);
+        e.mmap_size = pragma_integer(db, "PRAGMA mmap_size").value_or(0);
+        e.wal_autocheckpoint = pragma_integer(db, "PRAGMA wal_autocheckpoint").value_or(0);
+        e.busy_timeout = pragma_integer(db, "PRAGMA busy_timeout").value_or(0);
+        e.read_only = sqlite3_db_readonly(db, "main") == 1;
+        return e;
+    }
+    catch (...) {
+        return {};
+    }
+}
+
+auto OpenOptions::Effective::
+to_string() const
+-> std::string {
+    return std::format("journal_mode={} locking_mode={} synchronous={} temp_store={} cache_size={} mmap_size={} wal_autocheckpoint={} busy_timeout={} read_only={}",
+                       journal_mode, locking_mode, synchronous, temp_store, cache_size, mmap_size, wal_autocheckpoint, busy_timeout, read_only);
+}
@@ -0,0 +1,93 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include <optional>
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+
+/// How a connection is opened: open flags and PRAGMAs applied before the connection is used. \n
+/// Unset fields (DEFAULT / std::nullopt) keep SQLite's defaults.
+struct OpenOptions {
+    enum class JournalMode : u8 { DEFAULT, DELETE, TRUNCATE, PERSIST, MEMORY, WAL, OFF };
+    enum class Synchronous : u8 { DEFAULT, OFF, NORMAL, FULL, EXTRA };
+    enum class TempStore : u8 { DEFAULT, FILE, MEMORY };
+    /// MULTI_THREAD - SQLITE_OPEN_NOMUTEX (the connection is used by one thread at a time),
+    /// SERIALIZED - SQLITE_OPEN_FULLMUTEX.
+    enum class Threading : u8 { DEFAULT, MULTI_THREAD, SERIALIZED };
+
+    bool read_only{};
+    /// Create the database file if it does not exist.
+    bool create{};
+    Threading threading{};
+    JournalMode journal_mode{};
+    Synchronous synchronous{};
+    TempStore temp_store{};
+    /// Exclusive locking mode: the lock is kept until the connection is closed.
+    bool exclusive{};
+    /// Page cache: pages if positive, KiB if negative.
+    std::optional<i64> cache_size{};
+    /// Bytes of the database file accessed with memory-mapped I/O (0 disables it).
+    std::optional<i64> mmap_size{};
+    /// Pages of WAL after which the automatic checkpoint runs.
+    std::optional<i64> wal_autocheckpoint{};
+    /// Milliseconds a locked database is retried before SQLITE_BUSY.
+    std::optional<int> busy_timeout{};
+
+    /// Many concurrent readers: WAL, 1 GiB mmap, 64 MiB page cache.
+    static OpenOptions read_heavy() noexcept;
+    /// Frequent small transactions: WAL with synchronous NORMAL, rare checkpoints, waits for locks.
+    static OpenOptions write_heavy() noexcept;
+    /// One writer loading data: no journal, no syncs, exclusive lock (the file is lost on a crash).
+    static OpenOptions bulk_load() noexcept;
+
+    /// Values reported by SQLite after the options were applied.
+    struct Effective {
+        std::string journal_mode{};
+        std::string locking_mode{};
+        i64 synchronous{};          // 0 - OFF, 1 - NORMAL, 2 - FULL, 3 - EXTRA
+        i64 temp_store{};           // 0 - DEFAULT, 1 - FILE, 2 - MEMORY
+        i64 cache_size{};
+        i64 mmap_size{};
+        i64 wal_autocheckpoint{};
+        i64 busy_timeout{};
+        bool read_only{};
+        [[nodiscard]] std::string to_string() const;
+    };
+
+    /// Flags for sqlite3_open_v2.
+    [[nodiscard]] int flags() const noexcept;
+    /// PRAGMA statements in order of execution.
+    [[nodiscard]] std::vector<std::string> pragmas() const;
+    /// Apply PRAGMAs and the busy timeout to the just opened connection.
+    /// False if any of them failed or the journal mode was not accepted.
+    bool apply(sqlite3* db) const noexcept;
+    /// Read the current values from the connection.
+    static std::optional<Effective> effective(sqlite3* db) noexcept;
+};
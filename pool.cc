@@ -0,0 +1,215 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "pool.h"
+#include "logger.h"
+#include <algorithm>
+#include <cassert>
+#include <format>
+
+/********************************************************************
+*                                                                   *
+*                            L E A S E                              *
+*                                                                   *
+********************************************************************/
+
+ConnectionPool::Lease::~Lease() {
+    if (pool_)
+        pool_->give_back(slot_);
+}
+
+auto ConnectionPool::Lease::
+operator=(Lease&& rhs) noexcept
+-> Lease& {
+    if (this != &rhs) {
+        if (pool_)
+            pool_->give_back(slot_);
+        pool_ = std::exchange(rhs.pool_, nullptr);
+        slot_ = rhs.slot_;
+    }
+    return *this;
+}
+
+/********************************************************************
+*                                                                   *
+*                      O P E N  /  C L O S E                        *
+*                                                                   *
+********************************************************************/
+
+ConnectionPool::~ConnectionPool() {
+    // Leases point into the pool, none of them may outlive it.
+    std::lock_guard lock{mutex_};
+    assert(std::ranges::none_of(slots_, &Slot::in_use) && "ConnectionPool destroyed while connections are leased");
+    if (std::ranges::any_of(slots_, &Slot::in_use))
+        logger::error("Connection pool destroyed while some connections are in use.");
+    for (auto& slot : slots_)
+        slot.db->close();
+    slots_.clear();
+}
+
+auto ConnectionPool::
+open(std::string const& path, size_t const readers, OpenOptions const& options) noexcept
+-> bool {
+    std::lock_guard lock{mutex_};
+    if (!slots_.empty()) {
+        logger::warning("Connection pool is already opened!");
+        return {};
+    }
+
+    // The pool needs WAL and connections used by one thread at a time,
+    // the exclusive locking mode would lock readers out.
+    auto writer_options = options;
+    writer_options.read_only = false;
+    writer_options.threading = OpenOptions::Threading::MULTI_THREAD;
+    writer_options.journal_mode = OpenOptions::JournalMode::WAL;
+    writer_options.exclusive = false;
+
+    // The writer must be opened first, it switches the database file to WAL mode
+    // (the mode is persistent, readers opened later use it too).
+    auto writer = std::unique_ptr<SQLite>(new SQLite{});
+    if (!writer->open_with(path, writer_options, true)) {
+        logger::error("The database {} can't be switched to WAL mode.", path);
+        return {};
+    }
+    slots_.push_back(Slot{.db = std::move(writer), .writer = true});
+
+    auto reader_options = writer_options;
+    reader_options.read_only = true;
+    reader_options.create = false;
+    for (size_t i = 0; i < readers; ++i) {
+        auto reader = std::unique_ptr<SQLite>(new SQLite{});
+        if (!reader->open_with(path, reader_options, true)) {
+            for (auto& slot : slots_)
+                slot.db->close();
+            slots_.clear();
+            return {};
+        }
+        slots_.push_back(Slot{.db = std::move(reader)});
+    }
+    next_reader_ = 1;
+    return true;
+}
+
+auto ConnectionPool::
+close() noexcept
+-> bool {
+    std::lock_guard lock{mutex_};
+    if (std::ranges::any_of(slots_, &Slot::in_use)) {
+        logger::warning("Connection pool can't be closed, some connections are in use.");
+        return {};
+    }
+    auto ok = true;
+    for (auto& slot : slots_)
+        ok = slot.db->close() && ok;
+    slots_.clear();
+    return ok;
+}
+
+/********************************************************************
+*                                                                   *
+*                        C H E C K O U T                            *
+*                                                                   *
+********************************************************************/
+
+auto ConnectionPool::
+reader() noexcept
+-> std::optional<Lease> {
+    std::lock_guard lock{mutex_};
+    auto const n = slots_.size();
+    if (n > 1) {
+        // Search from the place where the previous search ended,
+        // so that the work is spread over all readers.
+        for (size_t i = 0; i < n - 1; ++i) {
+            auto const slot = 1 + (next_reader_ - 1 + i) % (n - 1);
+            if (!slots_[slot].in_use) {
+                next_reader_ = 1 + slot % (n - 1);
+                return checkout(slot);
+            }
+        }
+    }
+    ++rejected_;
+    return {};
+}
+
+auto ConnectionPool::
+writer() noexcept
+-> std::optional<Lease> {
+    std::lock_guard lock{mutex_};
+    if (!slots_.empty() && !slots_[WRITER].in_use)
+        return checkout(WRITER);
+    ++rejected_;
+    return {};
+}
+
+auto ConnectionPool::
+checkout(size_t const slot) noexcept
+-> std::optional<Lease> {
+    auto& s = slots_[slot];
+    s.in_use = true;
+    s.since = Clock::now();
+    ++s.checkouts;
+    return Lease{this, slot};
+}
+
+auto ConnectionPool::
+give_back(size_t const slot) noexcept
+-> void {
+    std::lock_guard lock{mutex_};
+    auto& s = slots_[slot];
+    s.busy_time += Clock::now() - s.since;
+    s.in_use = false;
+}
+
+/********************************************************************
+*                                                                   *
+*                       S T A T I S T I C S                         *
+*                                                                   *
+********************************************************************/
+
+auto ConnectionPool::
+stats() const
+-> std::vector<ConnectionStats> {
+    std::lock_guard lock{mutex_};
+    std::vector<ConnectionStats> result{};
+    result.reserve(slots_.size());
+    for (auto const& s : slots_)
+        result.push_back({
+            .writer = s.writer,
+            .in_use = s.in_use,
+            .checkouts = s.checkouts,
+            .busy_time = s.busy_time,
+            .cache = s.db->cache_stats()
+        });
+    return result;
+}
+
+auto ConnectionPool::
+rejected() const noexcept
+-> u64 {
+    std::lock_guard lock{mutex_};
+    return rejected_;
+}
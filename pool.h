@@ -0,0 +1,122 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include "sqlite.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// Set of connections to one database file: one writer and N readers. \n
+/// The database is switched to WAL mode, so readers do not block the writer
+/// (and each other). Connections are opened with SQLITE_OPEN_NOMUTEX,
+/// a connection is used only by the thread that holds its lease.
+class ConnectionPool {
+public:
+    struct ConnectionStats {
+        bool writer{};
+        bool in_use{};
+        u64 checkouts{};
+        std::chrono::nanoseconds busy_time{};
+        StmtCache::Stats cache{};
+    };
+
+    /// RAII checkout of a connection. The connection goes back to the pool
+    /// when the lease is destroyed.
+    class Lease {
+        ConnectionPool* pool_{};
+        size_t slot_{};
+    public:
+        Lease(ConnectionPool* pool, size_t const slot) : pool_{pool}, slot_{slot} {}
+        ~Lease();
+        /// No Copy
+        Lease(Lease const&) = delete;
+        Lease& operator=(Lease const&) = delete;
+        /// Move
+        Lease(Lease&& rhs) noexcept : pool_{std::exchange(rhs.pool_, nullptr)}, slot_{rhs.slot_} {}
+        Lease& operator=(Lease&& rhs) noexcept;
+
+        SQLite const& operator*() const noexcept {
+            return *pool_->slots_[slot_].db;
+        }
+        SQLite const* operator->() const noexcept {
+            return pool_->slots_[slot_].db.get();
+        }
+    };
+
+    ConnectionPool() = default;
+    ~ConnectionPool();
+    /// No Copy
+    ConnectionPool(ConnectionPool const&) = delete;
+    ConnectionPool& operator=(ConnectionPool const&) = delete;
+    /// No Move (leases point to the pool)
+    ConnectionPool(ConnectionPool&&) = delete;
+    ConnectionPool& operator=(ConnectionPool&&) = delete;
+
+    /// Open the writer and 'readers' reader connections to an existing database file.
+    /// All connections are opened with the options (WAL and SQLITE_OPEN_NOMUTEX are always used).
+    bool open(std::string const& path, size_t readers, OpenOptions const& options = {}) noexcept;
+    /// Close all connections (none of them can be leased).
+    /// The destructor closes them unconditionally, destroying the pool with
+    /// outstanding leases is a contract violation (asserted in debug builds).
+    bool close() noexcept;
+
+    /// Take a free reader connection.
+    /// Returns std::nullopt at once if all readers are in use (does not wait).
+    [[nodiscard]] std::optional<Lease> reader() noexcept;
+    /// Take the writer connection (std::nullopt at once if it is in use).
+    [[nodiscard]] std::optional<Lease> writer() noexcept;
+
+    /// Statistics of every connection (the writer is the first).
+    [[nodiscard]] std::vector<ConnectionStats> stats() const;
+    /// Number of checkouts rejected because the pool was exhausted.
+    [[nodiscard]] u64 rejected() const noexcept;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Slot {
+        std::unique_ptr<SQLite> db{};
+        bool writer{};
+        bool in_use{};
+        u64 checkouts{};
+        std::chrono::nanoseconds busy_time{};
+        Clock::time_point since{};
+    };
+    static constexpr size_t WRITER = 0;
+
+    mutable std::mutex mutex_;
+    std::vector<Slot> slots_{};
+    size_t next_reader_{1};
+    u64 rejected_{};
+
+    std::optional<Lease> checkout(size_t slot) noexcept;
+    void give_back(size_t slot) noexcept;
+};
@@ -26,7 +26,9 @@
 /*------- include files:
 -------------------------------------------------------------------*/
 #include "query.h"
-#include "gzip.h"
+#include "codec.h"
+#include "metrics.h"
+#include <limits>
 
 /********************************************************************
 *                                                                   *
@@ -37,84 +39,146 @@
 auto Query::
 to_bytes() const
 -> std::vector<char> {
-    // In the 'serialized_values' vector we will store the bytes from ALL serialized values.
-    std::vector<std::vector<char>> serialized_values{};
-    serialized_values.reserve(values_.size());
-    // Total number of bytes of ALL serialized values.
-    auto values_size = 0;
-
-    // All values to bytes
-    std::ranges::for_each(values_, [&values_size, &serialized_values](auto const& v) {
-        auto sv = v.to_bytes();
-        values_size += sv.size();
-        serialized_values.push_back(std::move(sv));
-    });
-
-    u16 const cmd_size = cmd_.size();
-    u16 const values_count = values_.size();
+    return to_bytes(wire::V1);
+}
+
+auto Query::
+to_bytes(wire::Version const version) const
+-> std::vector<char> {
+    metrics::Timer const timer{metrics::SERIALIZE};
+    auto const v = (version == wire::V1) ? this->version() : version;
+    std::vector<char> buffer(size_as(v));
+    Writer w{buffer};
+    write_as(w, v);
+    metrics::add(metrics::BYTES_SERIALIZED, buffer.size());
+    return buffer;
+}
+
+auto Query::
+to_bytes(std::pmr::memory_resource* const mr) const
+-> std::pmr::vector<char> {
+    metrics::Timer const timer{metrics::SERIALIZE};
+    auto const v = version();
+    std::pmr::vector<char> buffer(size_as(v), mr);
+    Writer w{buffer};
+    write_as(w, v);
+    metrics::add(metrics::BYTES_SERIALIZED, buffer.size());
+    return buffer;
+}
+
+auto Query::
+serialized_size() const noexcept
+-> size_t {
+    return size_as(version());
+}
+
+auto Query::
+serialized_size(wire::Version const version) const noexcept
+-> size_t {
+    // V1 can't describe everything (u16 counts), nothing is truncated.
+    return size_as((version == wire::V1) ? this->version() : version);
+}
+
+auto Query::
+write_to(Writer& w) const noexcept
+-> void {
+    write_as(w, version());
+}
+
+auto Query::
+write_to(Writer& w, wire::Version const version) const noexcept
+-> void {
+    write_as(w, (version == wire::V1) ? this->version() : version);
+}
+
+auto Query::
+size_as(wire::Version const version) const noexcept
+-> size_t {
+    if (version == wire::V2) {
+        auto const nbytes = body_size_v2();
+        return sizeof(char) + sizeof(u8) + wire::varint_size(nbytes) + nbytes;
+    }
+    return sizeof(char) + sizeof(u32) + body_size();
+}
+
+auto Query::
+write_as(Writer& w, wire::Version const version) const noexcept
+-> void {
+    if (version == wire::V2) {
+        // marker, version, varint size of the body, body
+        w.put(QUERY_MARKER_V2);
+        w.put(static_cast<u8>(wire::V2));
+        w.put_varint(body_size_v2());
+        w.put_varint(cmd_.size());
+        w.put(cmd_.data(), cmd_.size());
+        w.put_varint(values_.size());
+        for (auto const& v : values_)
+            v.encode_v2(w);
+        return;
+    }
 
     // Chunk size describes everything that is behind it.
-    u32 const chunk_size
-        = sizeof(u16)       // information about the command size
-        + sizeof(u16)       // information about number of values
-        + cmd_size          // command content bytes
-        + values_size;      // all values content bytes
+    w.put(QUERY_MARKER);
+    auto const chunk = w.begin_chunk();
+    write_body(w);
+    w.end_chunk(chunk);
+}
 
-    std::vector<char> buffer{};
-    buffer.reserve(sizeof(char) + sizeof(u32) + chunk_size);
+auto Query::
+version() const noexcept
+-> wire::Version {
+    constexpr size_t max = std::numeric_limits<u16>::max();
+    if (cmd_.size() > max || values_.size() > max)
+        return wire::V2;
+    return wire::V1;
+}
 
-    buffer.push_back(QUERY_MARKER);
-    std::copy_n(reinterpret_cast<char const*>(&chunk_size), sizeof(u32), std::back_inserter(buffer));
-    std::copy_n(reinterpret_cast<char const*>(&cmd_size), sizeof(u16), std::back_inserter(buffer));
-    std::copy_n(reinterpret_cast<char const*>(&values_count), sizeof(u16), std::back_inserter(buffer));
-    std::copy_n(cmd_.begin(), cmd_size, std::back_inserter(buffer));
-    std::ranges::for_each(serialized_values, [&buffer](auto sf) {
-        std::copy_n(sf.begin(), sf.size(), std::back_inserter(buffer));
-    });
+auto Query::
+body_size_v2() const noexcept
+-> size_t {
+    size_t nbytes
+        = wire::varint_size(cmd_.size())
+        + cmd_.size()
+        + wire::varint_size(values_.size());
+    for (auto const& v : values_)
+        nbytes += v.encoded_size_v2();
+    return nbytes;
+}
+
+auto Query::
+body_size() const noexcept
+-> size_t {
+    size_t nbytes
+        = sizeof(u16)       // information about the command size
+        + sizeof(u16)       // information about number of values
+        + cmd_.size();      // command content bytes
+    for (auto const& v : values_)
+        nbytes += v.serialized_size();
+    return nbytes;
+}
 
-    return std::move(buffer);
+auto Query::
+write_body(Writer& w) const noexcept
+-> void {
+    w.put(static_cast<u16>(cmd_.size()));
+    w.put(static_cast<u16>(values_.size()));
+    w.put(cmd_.data(), cmd_.size());
+    for (auto const& v : values_)
+        v.write_to(w);
 }
 
 auto Query::
 to_gzip_bytes() const
 -> std::vector<char> {
-    // In the 'serialized_values' vector we will store the bytes from ALL serialized values.
-    std::vector<std::vector<char>> serialized_values{};
-    serialized_values.reserve(values_.size());
-    // Total number of bytes of ALL serialized values.
-    auto values_size = 0;
-
-    // All values to bytes
-    std::ranges::for_each(values_, [&values_size, &serialized_values](auto const& v) {
-        auto sv = v.to_bytes();
-        values_size += sv.size();
-        serialized_values.push_back(std::move(sv));
-    });
-
-    u16 const cmd_size = cmd_.size();
-    u16 const values_count = values_.size();
-    std::vector<char> buffer{};
-    buffer.reserve(sizeof(u16) + sizeof(u16) + cmd_size + values_size);
-
-    std::copy_n(reinterpret_cast<char const*>(&cmd_size), sizeof(u16), std::back_inserter(buffer));
-    std::copy_n(reinterpret_cast<char const*>(&values_count), sizeof(u16), std::back_inserter(buffer));
-    std::copy_n(cmd_.begin(), cmd_size, std::back_inserter(buffer));
-    std::ranges::for_each(serialized_values, [&buffer](auto sf) {
-        std::copy_n(sf.begin(), sf.size(), std::back_inserter(buffer));
-    });
-
-    // The compressed serialization result ultimately consists of three components:
-    // 1. marker 'Q',
-    // 2. size of compressed data (u32)
-    // 3. compressed data
-    auto const compressed = gzip::compress(buffer);
-    u32 const nbytes = compressed.size();
-    std::vector<char> result{};
-    result.reserve(sizeof(u8) + sizeof(u32) + nbytes);
-    result.push_back(static_cast<char>(QUERY_MARKER | 0b1000'0000));
-    std::copy_n(reinterpret_cast<char const*>(&nbytes), sizeof(u32), std::back_inserter(result));
-    std::copy_n(compressed.data(), compressed.size(), std::back_inserter(result));
-    return std::move(result);
+    return to_compressed_bytes({codec::GZIP});
+}
+
+auto Query::
+to_compressed_bytes(codec::Options const options) const
+-> std::vector<char> {
+    if (auto compressed = codec::compress_frame(to_bytes(), options))
+        return std::move(*compressed);
+    return {};
 }
 
 /********************************************************************
@@ -132,6 +196,8 @@ from_bytes(std::span<char> span)
     // It is possible that the data is packed
     if (auto const marker = span.front(); (marker & 0b1000'0000) == 0b1000'0000)
         return from_gzip_bytes(span);
+    if (span.front() == QUERY_MARKER_V2)
+        return from_bytes_v2(span);
 
     if (span.front() == QUERY_MARKER) {
         span = span.subspan(1);
@@ -160,12 +226,57 @@ from_bytes(std::span<char> span)
     return {{}, 0};
 }
 
+auto Query::
+from_bytes_v2(std::span<const char> const span)
+-> std::pair<Query,size_t> {
+    Reader r{span};
+    if (r.get() != QUERY_MARKER_V2 || r.get<u8>() != wire::V2)
+        return {};
+    auto const nbytes = r.varint();
+    if (!nbytes)
+        return {};
+    auto const body = r.bytes(*nbytes);
+    if (!body)
+        return {};
+
+    Reader b{*body};
+    auto const cmd_size = b.varint();
+    if (!cmd_size)
+        return {};
+    auto const cmd = b.bytes(*cmd_size);
+    auto const values_count = b.varint();
+    // every value takes at least 1 byte
+    if (!cmd || !values_count || *values_count > b.left())
+        return {};
+    Query query{std::string{cmd->begin(), cmd->end()}};
+    query.values_.reserve(*values_count);
+    for (u64 i = 0; i < *values_count; ++i) {
+        auto v = Value::decode_v2(b);
+        if (!v)
+            return {};
+        query.add_arg(std::move(*v));
+    }
+    return {std::move(query), r.consumed()};
+}
+
 auto Query::
 from_gzip_bytes(std::span<const char> span)
 -> std::pair<Query,size_t> {
     if (span.empty())
         return {};
 
+    // Compressed frame with the uncompressed size and codec id, the complete frame is inside.
+    if (codec::is_compressed(span.front()) && codec::codec_bits(span.front()) != codec::LEGACY_GZIP) {
+        auto frame = codec::decompress_frame(span);
+        if (!frame)
+            return {};
+        auto [object, nbytes] = from_bytes(frame->first);
+        if (nbytes == 0)
+            return {};
+        return {std::move(object), frame->second};
+    }
+
+    // Legacy gzip frame: marker, compressed size and the compressed body.
     if (auto const marker = span.front(); (marker & 0b1000'0000) == 0b1000'0000) {
         if (static_cast<char>(marker & ~0b1000'0000) == QUERY_MARKER) {
             span = span.subspan(1);
@@ -176,7 +287,10 @@ from_gzip_bytes(std::span<const char> span)
                     // the number of bytes of which is equal to the designated size.
                     // And only they are of interest to us.
                     span = span.first(*nbytes);
-                    auto unpacked_data = gzip::decompress(span);
+                    auto const unpacked = codec::gunzip(span);
+                    if (!unpacked)
+                        return {};
+                    auto const& unpacked_data = *unpacked;
                     span = std::span(unpacked_data.data(), unpacked_data.size());
                     // From now on we are working on unpacked data
 
@@ -27,16 +27,20 @@
 /*------- include files:
 -------------------------------------------------------------------*/
 #include <string>
+#include <utility>
 #include <vector>
 #include <format>
-#include <iostream>
 #include <algorithm>
+#include <memory_resource>
 #include "value.h"
+#include "codec.h"
+#include "logger.h"
 
 class Query {
     std::string cmd_;
     std::vector<Value> values_;
     static constexpr char QUERY_MARKER{'Q'};
+    static constexpr char QUERY_MARKER_V2{'q'};
 
 public:
     Query() = default;
@@ -52,7 +56,9 @@ public:
     /// Query for name with arguments.
     Query(std::string cmd, std::vector<Value> data): cmd_{std::move(cmd)}, values_{std::move(data)} {}
 
-    /// Query for name and arguments with fold-expression
+    /// Query for name and arguments with fold-expression. \n
+    /// Large text and blobs can be passed as Value::ref(...) to avoid copying them,
+    /// they are bound to the statement without a copy too.
     template<typename... T>
     explicit Query(std::string cmd, T... args) : cmd_{std::move(cmd)} {
         (..., values_.push_back(Value(args)));
@@ -62,11 +68,28 @@ public:
         values_.push_back(std::move(v));
     }
 
-    /// Serialization. Converting a Query to bytes.
+    /// Serialization. Converting a Query to bytes. \n
+    /// V1 format is used while the query fits it (u16 sizes), V2 otherwise (nothing is truncated).
     [[nodiscard]] std::vector<char> to_bytes() const;
+    [[nodiscard]] std::vector<char> to_bytes(wire::Version version) const;
+    /// Serialization into the buffer allocated from the memory resource.
+    [[nodiscard]] std::pmr::vector<char> to_bytes(std::pmr::memory_resource* mr) const;
     [[nodiscard]] std::vector<char> to_gzip_bytes() const;
+    /// Serialization into the compressed frame (codec, level), the uncompressed size is in the frame.
+    [[nodiscard]] std::vector<char> to_compressed_bytes(codec::Options options = {}) const;
+    /// Number of bytes of the serialized query (in the format of to_bytes()).
+    [[nodiscard]] size_t serialized_size() const noexcept;
+    /// Number of bytes of the query serialized in the format 'version'
+    /// (V2 if V1 was requested and the query does not fit it).
+    [[nodiscard]] size_t serialized_size(wire::Version version) const noexcept;
+    /// Serialization directly into the writer (one pass, no intermediate buffers).
+    void write_to(Writer& w) const noexcept;
+    /// Serialization in the format 'version', the query that does not fit V1 is written as V2.
+    void write_to(Writer& w, wire::Version version) const noexcept;
+    /// The format version used by to_bytes(): V1 if the query fits it.
+    [[nodiscard]] wire::Version version() const noexcept;
 
-    /// Deserialization. Recreate Query from bytes.
+    /// Deserialization. Recreate Query from bytes (any format version, compressed or not).
     static std::pair<Query,size_t> from_bytes(std::span<char> span);
     static std::pair<Query,size_t> from_gzip_bytes(std::span<const char> span);
 
@@ -80,13 +103,11 @@ public:
 
     /// Check if query is valid. \n
     /// The query is valid if the number of placeholders(?) is equal
-    /// to the number of query arguments.
+    /// to the number of query arguments (question marks in literals are not placeholders).
     [[nodiscard]] bool valid() const {
-        auto placeholder_count = std::ranges::count_if(cmd_, [](char const c) {
-            return '?' == c;
-        });
+        auto const placeholder_count = shared::placeholder_count(cmd_);
         if (std::cmp_not_equal(placeholder_count, values_.size())) {
-            std::cerr << std::format("The number of placeholders and arguments does not match ({}, {})\n", placeholder_count, values_.size());
+            logger::error("The number of placeholders and arguments does not match ({}, {})", placeholder_count, values_.size());
             return {};
         }
         return true;
@@ -114,4 +135,14 @@ public:
         buffer.shrink_to_fit();
         return buffer;
     }
+
+private:
+    /// Size and serialization in exactly the given format.
+    [[nodiscard]] size_t size_as(wire::Version version) const noexcept;
+    void write_as(Writer& w, wire::Version version) const noexcept;
+    /// Sizes, command and all values (body of the chunk).
+    [[nodiscard]] size_t body_size() const noexcept;
+    void write_body(Writer& w) const noexcept;
+    [[nodiscard]] size_t body_size_v2() const noexcept;
+    static std::pair<Query,size_t> from_bytes_v2(std::span<const char> span);
 };
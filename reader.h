@@ -0,0 +1,88 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include <span>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+/// Bounds-checked sequential reader of serialized data (counterpart of the Writer). \n
+/// Every read checks the remaining bytes, a failed read leaves the reader in the failed state.
+class Reader {
+    std::span<const char> span_;
+    size_t pos_{};
+public:
+    explicit Reader(std::span<const char> const span) noexcept : span_{span} {}
+
+    /// Number of bytes consumed so far.
+    [[nodiscard]] size_t consumed() const noexcept {
+        return pos_;
+    }
+    /// Number of bytes left.
+    [[nodiscard]] size_t left() const noexcept {
+        return span_.size() - pos_;
+    }
+
+    [[nodiscard]] std::optional<char> get() noexcept {
+        if (left() < 1)
+            return {};
+        return span_[pos_++];
+    }
+    template<typename T>
+        requires std::is_arithmetic_v<T>
+    [[nodiscard]] std::optional<T> get() noexcept {
+        if (left() < sizeof(T))
+            return {};
+        T v{};
+        std::memcpy(&v, span_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return v;
+    }
+    /// Next 'n' bytes (without copying).
+    [[nodiscard]] std::optional<std::span<const char>> bytes(size_t const n) noexcept {
+        if (left() < n)
+            return {};
+        auto const data = span_.subspan(pos_, n);
+        pos_ += n;
+        return data;
+    }
+    /// Read LEB128 varint (at most 10 bytes).
+    [[nodiscard]] std::optional<u64> varint() noexcept {
+        u64 v = 0;
+        for (uint shift = 0; shift < 64; shift += 7) {
+            if (left() < 1)
+                return {};
+            auto const byte = static_cast<u8>(span_[pos_++]);
+            v |= static_cast<u64>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return v;
+        }
+        return {};
+    }
+};
@@ -26,7 +26,11 @@
 /*------- include files:
 -------------------------------------------------------------------*/
 #include "result.h"
-#include "gzip.h"
+#include "codec.h"
+#include "columnar.h"
+#include "metrics.h"
+#include <algorithm>
+#include <limits>
 
 /********************************************************************
 *                                                                   *
@@ -55,33 +59,129 @@ auto Result
 auto Result::
 to_bytes() const
 -> std::vector<char> {
-    std::vector<std::vector<char>> serialized_rows{};
-    const u16 rows_count = data_.size();
-    serialized_rows.reserve(rows_count);
-    size_t rows_size = 0;
-
-    for (const auto& row : data_) {
-        auto sr = row.to_bytes();
-        rows_size += sr.size();
-        serialized_rows.push_back(std::move(sr));
+    return to_bytes(wire::V1);
+}
+
+auto Result::
+to_bytes(wire::Version const version) const
+-> std::vector<char> {
+    metrics::Timer const timer{metrics::SERIALIZE};
+    auto const v = (version == wire::V1) ? this->version() : version;
+    std::vector<char> buffer(size_as(v));
+    Writer w{buffer};
+    write_as(w, v);
+    metrics::add(metrics::BYTES_SERIALIZED, buffer.size());
+    return buffer;
+}
+
+auto Result::
+to_bytes(std::pmr::memory_resource* const mr) const
+-> std::pmr::vector<char> {
+    metrics::Timer const timer{metrics::SERIALIZE};
+    auto const v = version();
+    std::pmr::vector<char> buffer(size_as(v), mr);
+    Writer w{buffer};
+    write_as(w, v);
+    metrics::add(metrics::BYTES_SERIALIZED, buffer.size());
+    return buffer;
+}
+
+auto Result::
+serialized_size() const noexcept
+-> size_t {
+    return size_as(version());
+}
+
+auto Result::
+serialized_size(wire::Version const version) const noexcept
+-> size_t {
+    // V1 can't describe everything (u16 counts), nothing is truncated.
+    return size_as((version == wire::V1) ? this->version() : version);
+}
+
+auto Result::
+write_to(Writer& w) const noexcept
+-> void {
+    write_as(w, version());
+}
+
+auto Result::
+write_to(Writer& w, wire::Version const version) const noexcept
+-> void {
+    write_as(w, (version == wire::V1) ? this->version() : version);
+}
+
+auto Result::
+size_as(wire::Version const version) const noexcept
+-> size_t {
+    if (version == wire::V2) {
+        auto const nbytes = body_size_v2();
+        return sizeof(char) + sizeof(u8) + wire::varint_size(nbytes) + nbytes;
+    }
+    return sizeof(char) + sizeof(u32) + body_size();
+}
+
+auto Result::
+write_as(Writer& w, wire::Version const version) const noexcept
+-> void {
+    if (version == wire::V2) {
+        // marker, version, varint size of the body, body
+        w.put(RESULT_MARKER_V2);
+        w.put(static_cast<u8>(wire::V2));
+        w.put_varint(body_size_v2());
+        w.put_varint(data_.size());
+        for (const auto& row : data_)
+            row.encode_v2(w);
+        return;
     }
 
     // Chunk size describes everything that is behind it.
-    u32 const chunk_size
-        = sizeof(u16)   // rows number
-        + rows_size;    // bytes number of sll rows
-
-    std::vector<char> buffer{};
-    buffer.reserve(sizeof(char) + sizeof(u32) + chunk_size);
-
-    buffer.push_back(RESULT_MARKER);
-    std::copy_n(reinterpret_cast<char const*>(&chunk_size), sizeof(u32), std::back_inserter(buffer));
-    std::copy_n(reinterpret_cast<char const*>(&rows_count), sizeof(u16), std::back_inserter(buffer));
-    std::ranges::for_each(serialized_rows, [&buffer](auto sf) {
-        std::copy_n(sf.begin(), sf.size(), std::back_inserter(buffer));
-    });
+    w.put(RESULT_MARKER);
+    auto const chunk = w.begin_chunk();
+    write_body(w);
+    w.end_chunk(chunk);
+}
 
-    return std::move(buffer);
+auto Result::
+to_columnar_bytes(bool const dictionary) const
+-> std::vector<char> {
+    return ColumnarResult::from_result(*this).to_bytes(dictionary);
+}
+
+auto Result::
+version() const noexcept
+-> wire::Version {
+    if (data_.size() > std::numeric_limits<u16>::max())
+        return wire::V2;
+    if (!std::ranges::all_of(data_, [](auto const& row) { return row.fits_v1(); }))
+        return wire::V2;
+    return wire::V1;
+}
+
+auto Result::
+body_size_v2() const noexcept
+-> size_t {
+    size_t nbytes = wire::varint_size(data_.size());
+    for (const auto& row : data_)
+        nbytes += row.encoded_size_v2();
+    return nbytes;
+}
+
+auto Result::
+body_size() const noexcept
+-> size_t {
+    size_t nbytes = sizeof(u16);   // rows number
+    for (const auto& row : data_)
+        nbytes += row.serialized_size();
+    return nbytes;
+}
+
+auto Result::
+write_body(Writer& w) const noexcept
+-> void {
+    w.put(static_cast<u16>(data_.size()));
+    for (const auto& row : data_)
+        row.write_to(w);
 }
 
 /********************************************************************
@@ -98,6 +198,14 @@ std::pair<Result,size_t> {
 
     if (auto const marker = span.front(); (marker & 0b1000'0000) == 0b1000'0000)
         return from_gzip_bytes(span);
+    if (span.front() == RESULT_MARKER_V2)
+        return from_bytes_v2(span);
+    if (span.front() == COLUMNAR_MARKER) {
+        auto [columnar, nbytes] = ColumnarResult::from_bytes(span);
+        if (nbytes == 0)
+            return {};
+        return {columnar.to_result(), nbytes};
+    }
 
     if (!span.empty() && span.front() == RESULT_MARKER) {
         span = span.subspan(1);
@@ -122,36 +230,47 @@ std::pair<Result,size_t> {
     return {};
 }
 
+auto Result::
+from_bytes_v2(std::span<const char> const span) ->
+std::pair<Result,size_t> {
+    Reader r{span};
+    if (r.get() != RESULT_MARKER_V2 || r.get<u8>() != wire::V2)
+        return {};
+    auto const nbytes = r.varint();
+    if (!nbytes)
+        return {};
+    auto const body = r.bytes(*nbytes);
+    if (!body)
+        return {};
+
+    Reader b{*body};
+    auto const rows_count = b.varint();
+    // every row takes at least 1 byte
+    if (!rows_count || *rows_count > b.left())
+        return {};
+    Result result{};
+    result.data_.reserve(*rows_count);
+    for (u64 i = 0; i < *rows_count; ++i) {
+        auto row = Row::decode_v2(b);
+        if (!row)
+            return {};
+        result.add(std::move(*row));
+    }
+    return {std::move(result), r.consumed()};
+}
 
 auto Result::
 to_gzip_bytes() const
 -> std::vector<char> {
-    std::vector<std::vector<char>> serialized_rows{};
-    const u16 rows_count = data_.size();
-    serialized_rows.reserve(rows_count);
-    size_t rows_size = 0;
-
-    for (const auto& row : data_) {
-        auto sr = row.to_bytes();
-        rows_size += sr.size();
-        serialized_rows.push_back(std::move(sr));
-    }
-
-    std::vector<char> buffer{};
-    buffer.reserve(sizeof(u16) + rows_size);
-    std::copy_n(reinterpret_cast<char const*>(&rows_count), sizeof(u16), std::back_inserter(buffer));
-    std::ranges::for_each(serialized_rows, [&buffer](auto sf) {
-        std::copy_n(sf.begin(), sf.size(), std::back_inserter(buffer));
-    });
+    return to_compressed_bytes({codec::GZIP});
+}
 
-    auto const compressed = gzip::compress(buffer);
-    u32 const nbytes = compressed.size();
-    std::vector<char> result{};
-    result.reserve(sizeof(char) + sizeof(u32) + compressed.size());
-    result.push_back(static_cast<char>(RESULT_MARKER | 0b1000'0000));
-    std::copy_n(reinterpret_cast<char const*>(&nbytes), sizeof(u32), std::back_inserter(result));
-    std::copy_n(compressed.begin(), compressed.size(), std::back_inserter(result));
-    return std::move(result);
+auto Result::
+to_compressed_bytes(codec::Options const options) const
+-> std::vector<char> {
+    if (auto compressed = codec::compress_frame(to_bytes(), options))
+        return std::move(*compressed);
+    return {};
 }
 
 auto Result::
@@ -160,6 +279,18 @@ std::pair<Result,size_t> {
     if (span.empty())
         return {};
 
+    // Compressed frame with the uncompressed size and codec id, the complete frame is inside.
+    if (codec::is_compressed(span.front()) && codec::codec_bits(span.front()) != codec::LEGACY_GZIP) {
+        auto const frame = codec::decompress_frame(span);
+        if (!frame)
+            return {};
+        auto [object, nbytes] = from_bytes(frame->first);
+        if (nbytes == 0)
+            return {};
+        return {std::move(object), frame->second};
+    }
+
+    // Legacy gzip frame: marker, compressed size and the compressed body.
     if (auto const marker = span.front(); (marker & 0b1000'0000) == 0b1000'0000) {
         if (static_cast<char>(marker & ~0b1000'0000) == RESULT_MARKER) {
             span = span.subspan(1);
@@ -170,7 +301,10 @@ std::pair<Result,size_t> {
                     // the number of bytes of which is equal to the designated size.
                     // And only they are of interest to us.
                     span = span.first(*nbytes);
-                    auto unpacked_data = gzip::decompress(span);
+                    auto const unpacked = codec::gunzip(span);
+                    if (!unpacked)
+                        return {};
+                    auto const& unpacked_data = *unpacked;
                     span = std::span(unpacked_data.data(), unpacked_data.size());
                     // From now on we are working on unpacked data
 
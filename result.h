@@ -27,11 +27,15 @@
 /*------- include files:
 -------------------------------------------------------------------*/
 #include <vector>
+#include <memory_resource>
 #include "row.h"
+#include "codec.h"
 
 class Result {
     std::vector<Row> data_;
     static constexpr char RESULT_MARKER{'T'};
+    static constexpr char RESULT_MARKER_V2{'t'};
+    static constexpr char COLUMNAR_MARKER{'C'};
 public:
     Result() = default;
     ~Result() = default;
@@ -62,15 +66,45 @@ public:
     }
 
 
-    /// Serialization. Converting a Field to bytes.
+    /// Serialization. Converting a Result to bytes. \n
+    /// V1 format is used while the result fits it (u16 counts), V2 otherwise (nothing is truncated).
     [[nodiscard]] auto to_bytes() const -> std::vector<char>;
+    [[nodiscard]] auto to_bytes(wire::Version version) const -> std::vector<char>;
+    /// Serialization into the buffer allocated from the memory resource.
+    [[nodiscard]] auto to_bytes(std::pmr::memory_resource* mr) const -> std::pmr::vector<char>;
     [[nodiscard]] auto to_gzip_bytes() const -> std::vector<char>;
+    /// Serialization into the compressed frame (codec, level), the uncompressed size is in the frame.
+    [[nodiscard]] auto to_compressed_bytes(codec::Options options = {}) const -> std::vector<char>;
+    /// Column-oriented serialization (schema once, column segments, see ColumnarResult::to_bytes).
+    /// from_bytes() recognizes it too.
+    [[nodiscard]] auto to_columnar_bytes(bool dictionary = true) const -> std::vector<char>;
+    /// Number of bytes of the serialized result (in the format of to_bytes()).
+    [[nodiscard]] auto serialized_size() const noexcept -> size_t;
+    /// Number of bytes of the result serialized in the format 'version'
+    /// (V2 if V1 was requested and the result does not fit it).
+    [[nodiscard]] auto serialized_size(wire::Version version) const noexcept -> size_t;
+    /// Serialization directly into the writer (one pass, no intermediate buffers).
+    auto write_to(Writer& w) const noexcept -> void;
+    /// Serialization in the format 'version', the result that does not fit V1 is written as V2.
+    auto write_to(Writer& w, wire::Version version) const noexcept -> void;
+    /// The format version used by to_bytes(): V1 if the result fits it.
+    [[nodiscard]] auto version() const noexcept -> wire::Version;
 
-    /// Deserialization. Recreate Field from bytes.
+    /// Deserialization. Recreate Result from bytes (any format version, compressed or not).
     static auto from_bytes(std::span<const char> span) -> std::pair<Result,size_t>;
     static auto from_gzip_bytes(std::span<const char> span) -> std::pair<Result,size_t>;
 
     auto to_string() const -> std::string;
+private:
+    /// Size and serialization in exactly the given format.
+    auto size_as(wire::Version version) const noexcept -> size_t;
+    auto write_as(Writer& w, wire::Version version) const noexcept -> void;
+    /// Number of rows and all rows (body of the chunk).
+    auto body_size() const noexcept -> size_t;
+    auto write_body(Writer& w) const noexcept -> void;
+    auto body_size_v2() const noexcept -> size_t;
+    static auto from_bytes_v2(std::span<const char> span) -> std::pair<Result,size_t>;
+public:
 
     /// Serialized data info. Generally for debug.
     // static auto serialized_data(std::span<u8> span) -> std::string;
@@ -26,8 +26,9 @@
 /*------- include files:
 -------------------------------------------------------------------*/
 #include "row.h"
+#include "logger.h"
 #include <format>
-#include <iostream>
+#include <algorithm>
 
 auto Row::
 to_string()
@@ -63,32 +64,82 @@ to_string()
 auto Row::
 to_bytes() const ->
 std::vector<char> {
-    std::vector<std::vector<char>> serialized_fields{};
-    const u16 fields_count = data_.size();
-    serialized_fields.reserve(fields_count);
-    size_t values_size = 0;
-
-    for (auto const& [_, field] : data_) {
-        auto sf = field.to_bytes();
-        values_size += sf.size();
-        serialized_fields.push_back(sf);
-    }
+    std::vector<char> buffer(serialized_size());
+    Writer w{buffer};
+    write_to(w);
+    return buffer;
+}
 
-    u32 const chunk_size
-        = sizeof(u16)   // fields number
-        + values_size;  // bytes number of all fields
+auto Row::
+serialized_size() const noexcept ->
+size_t {
+    size_t nbytes
+        = sizeof(char)  // marker
+        + sizeof(u32)   // chunk size
+        + sizeof(u16);  // fields number
+    for (auto const& [_, field] : data_)
+        nbytes += field.serialized_size();
+    return nbytes;
+}
 
-    std::vector<char> buffer{};
-    buffer.reserve(sizeof(char) + sizeof(u32) + chunk_size);
+auto Row::
+write_to(Writer& w) const noexcept ->
+void {
+    w.put('R');
+    auto const chunk = w.begin_chunk();
+    w.put(static_cast<u16>(data_.size()));
+    for (auto const& [_, field] : data_)
+        field.write_to(w);
+    w.end_chunk(chunk);
+}
 
-    buffer.push_back('R');
-    std::copy_n(reinterpret_cast<u8 const*>(&chunk_size), sizeof(u32), std::back_inserter(buffer));
-    std::copy_n(reinterpret_cast<u8 const*>(&fields_count), sizeof(u16), std::back_inserter(buffer));
-    std::ranges::for_each(serialized_fields, [&buffer](auto sf) {
-        std::copy_n(sf.begin(), sf.size(), std::back_inserter(buffer));
-    });
+auto Row::
+fits_v1() const noexcept ->
+bool {
+    if (data_.size() > std::numeric_limits<u16>::max())
+        return false;
+    return std::ranges::all_of(data_, [](auto const& item) { return item.second.fits_v1(); });
+}
 
-    return buffer;
+/********************************************************************
+*                                                                   *
+*                              V 2                                  *
+*                                                                   *
+********************************************************************/
+
+auto Row::
+encoded_size_v2() const noexcept ->
+size_t {
+    size_t nbytes = wire::varint_size(data_.size());
+    for (auto const& [_, field] : data_)
+        nbytes += field.encoded_size_v2();
+    return nbytes;
+}
+
+auto Row::
+encode_v2(Writer& w) const noexcept ->
+void {
+    w.put_varint(data_.size());
+    for (auto const& [_, field] : data_)
+        field.encode_v2(w);
+}
+
+auto Row::
+decode_v2(Reader& r) ->
+std::optional<Row> {
+    auto const count = r.varint();
+    // every field takes at least 2 bytes (name size and marker)
+    if (!count || *count > r.left() / 2)
+        return {};
+
+    Row row{};
+    for (u64 i = 0; i < *count; ++i) {
+        auto field = Field::decode_v2(r);
+        if (!field)
+            return {};
+        row.add(*field);
+    }
+    return row;
 }
 
 /********************************************************************
@@ -148,7 +199,7 @@ serialized_data(std::span<char> span)
                 size_t const values_count = *reinterpret_cast<u16*>(span_values_count.data());
                 buffer.append(std::format("{} [{}]\n", shared::hex_bytes_as_str(span_values_count), values_count));
                 span = span.subspan(sizeof(u16));
-                std::cout << "---------\n" << std::flush;
+                logger::debug("---------");
                 for (size_t i = 0; i < values_count; ++i) {
                     // we take bytes describing the size of the field
                     auto span_size = span.subspan(0, sizeof(u32));
@@ -54,6 +54,10 @@ public:
         if (data_.contains(name)) return data_[name];
         return {};
     }
+    std::optional<Field> operator[](std::string const& name) const {
+        if (auto const it = data_.find(name); it != data_.end()) return it->second;
+        return {};
+    }
     auto size() const {
         return data_.size();
     }
@@ -84,6 +88,17 @@ public:
 
     /// Serialization. Converting a Field to bytes.
     auto to_bytes() const -> std::vector<char>;
+    /// Number of bytes of the serialized row.
+    [[nodiscard]] auto serialized_size() const noexcept -> size_t;
+    /// Serialization directly into the writer.
+    auto write_to(Writer& w) const noexcept -> void;
+    /// The row fits V1 format (u16 number of fields and u16 names).
+    [[nodiscard]] bool fits_v1() const noexcept;
+
+    /// V2 encoding of the row inside of V2 frame.
+    [[nodiscard]] auto encoded_size_v2() const noexcept -> size_t;
+    auto encode_v2(Writer& w) const noexcept -> void;
+    static auto decode_v2(Reader& r) -> std::optional<Row>;
 
     /// Deserialization. Recreate Field from bytes.
     static auto from_bytes(std::span<const char> span) -> std::pair<Row,size_t>;
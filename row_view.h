@@ -0,0 +1,95 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include "value.h"
+#include "row.h"
+#include <optional>
+#include <span>
+#include <string_view>
+#include <sqlite3.h>
+
+/// Borrowed view of the current row of a statement. \n
+/// Text, blobs and names point directly into SQLite's buffers, nothing is copied.
+/// Text and blobs are valid only until the next step of the statement,
+/// names until the statement is finalized.
+class RowView {
+    sqlite3_stmt* stmt_{};
+    int column_count_{};
+public:
+    explicit RowView(sqlite3_stmt* const stmt) noexcept
+        : stmt_{stmt}, column_count_{sqlite3_column_count(stmt)} {}
+
+    [[nodiscard]] int size() const noexcept {
+        return column_count_;
+    }
+    [[nodiscard]] std::string_view name(int const i) const noexcept {
+        return sqlite3_column_name(stmt_, i);
+    }
+    /// Position of the column with given name (linear search, no allocation).
+    [[nodiscard]] std::optional<int> index(std::string_view const name) const noexcept {
+        for (auto i = 0; i < column_count_; ++i)
+            if (this->name(i) == name)
+                return i;
+        return {};
+    }
+
+    /// Kind of the value, i.e. Value::MONOSTATE, INTEGER, DOUBLE, STRING, VECTOR
+    [[nodiscard]] uint kind(int const i) const noexcept {
+        switch (sqlite3_column_type(stmt_, i)) {
+            case SQLITE_INTEGER: return Value::INTEGER;
+            case SQLITE_FLOAT:   return Value::DOUBLE;
+            case SQLITE_TEXT:    return Value::STRING;
+            case SQLITE_BLOB:    return Value::VECTOR;
+            default:             return Value::MONOSTATE;
+        }
+    }
+    [[nodiscard]] bool is_null(int const i) const noexcept {
+        return sqlite3_column_type(stmt_, i) == SQLITE_NULL;
+    }
+    [[nodiscard]] i64 integer(int const i) const noexcept {
+        return sqlite3_column_int64(stmt_, i);
+    }
+    [[nodiscard]] f64 real(int const i) const noexcept {
+        return sqlite3_column_double(stmt_, i);
+    }
+    [[nodiscard]] std::string_view text(int const i) const noexcept {
+        // The pointer must be taken before the size (the size of converted text may differ).
+        auto const ptr = reinterpret_cast<char const*>(sqlite3_column_text(stmt_, i));
+        return {ptr ? ptr : "", static_cast<size_t>(sqlite3_column_bytes(stmt_, i))};
+    }
+    [[nodiscard]] std::span<const u8> blob(int const i) const noexcept {
+        auto const ptr = static_cast<u8 const*>(sqlite3_column_blob(stmt_, i));
+        return {ptr, static_cast<size_t>(sqlite3_column_bytes(stmt_, i))};
+    }
+
+    /// Copy the cell to an (owning) Value.
+    [[nodiscard]] Value value(int i) const;
+    /// Copy the whole row.
+    [[nodiscard]] Row to_row() const;
+};
@@ -27,12 +27,12 @@
 /*------- include files:
 -------------------------------------------------------------------*/
 #include "types.h"
+#include "logger.h"
 #include <span>
 #include <string>
 #include <optional>
 #include <charconv>
 #include <format>
-#include <iostream>
 #include <range/v3/all.hpp>
 
 namespace shared {
@@ -98,12 +98,24 @@ namespace shared {
 
         // Coś poszło nie tak.
         if (ec == std::errc::invalid_argument)
-            std::cerr << std::format("This is not a number ({}).\n", sv);
+            logger::error("This is not a number ({}).", sv);
         else if (ec == std::errc::result_out_of_range)
-            std::cerr << std::format("The number is to big ({}).\n", sv);
+            logger::error("The number is to big ({}).", sv);
         return {};
     }
 
+    /// Quote the SQL identifier (table or column name), embedded quotes are doubled.
+    static inline std::string quote_identifier(std::string_view const name) {
+        std::string out{"\""};
+        for (auto const c : name) {
+            if (c == '"')
+                out += '"';
+            out += c;
+        }
+        out += '"';
+        return out;
+    }
+
     static inline std::string to_string(std::integral auto v) {
         return std::to_string(static_cast<i64>(v));
     }
@@ -111,6 +123,47 @@ namespace shared {
         return std::to_string(static_cast<f64>(v));
     }
 
+    /// Count placeholders (?) in the SQL text.
+    /// Question marks inside string literals, quoted identifiers and comments are skipped.
+    constexpr size_t placeholder_count(std::string_view const sql) noexcept {
+        size_t count = 0;
+        for (size_t i = 0; i < sql.size(); ++i) {
+            switch (auto const c = sql[i]) {
+                case '?':
+                    ++count;
+                    break;
+                case '\'':
+                case '"':
+                case '`': {
+                    // A doubled quote inside the literal is a quote too, it is handled as two literals.
+                    auto const end = sql.find(c, i + 1);
+                    i = (end == std::string_view::npos) ? sql.size() : end;
+                    break;
+                }
+                case '[': {
+                    auto const end = sql.find(']', i + 1);
+                    i = (end == std::string_view::npos) ? sql.size() : end;
+                    break;
+                }
+                case '-':
+                    if (i + 1 < sql.size() && sql[i + 1] == '-') {
+                        auto const end = sql.find('\n', i + 2);
+                        i = (end == std::string_view::npos) ? sql.size() : end;
+                    }
+                    break;
+                case '/':
+                    if (i + 1 < sql.size() && sql[i + 1] == '*') {
+                        auto const end = sql.find("*/", i + 2);
+                        i = (end == std::string_view::npos) ? sql.size() : end + 1;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        return count;
+    }
+
     template<std::integral T>
     std::optional<T> from(std::span<const char> const span) noexcept {
         if (span.size() >= sizeof(T))
@@ -29,12 +29,14 @@
 #include "logger.h"
 #include "value.h"
 #include "query.h"
-#include <iostream>
 #include <format>
+#include <fstream>
 
 // Close database (if needed and possible).
 bool SQLite::close() noexcept {
     if (db_) {
+        // Cached statements must be finalized before the connection is closed.
+        cache_.clear();
         if (sqlite3_close_v2(db_) != SQLITE_OK) {
             LOG_ERROR(db_);
             return {};
@@ -46,32 +48,148 @@ bool SQLite::close() noexcept {
 
 // Open database with given path.
 bool SQLite::open(std::string const& path, bool const expected_success, bool const read_only) noexcept {
-    if (db_) {
-        std::cout << "Database is already opened!\n" << std::flush;
+    if (path == IN_MEMORY) {
+        logger::warning("Database in memory can't be opened (use create).");
         return false;
     }
+    return open_with(path, OpenOptions{.read_only = read_only}, expected_success);
+}
+
+// Open database with given options (flags and PRAGMAs).
+bool SQLite::open(std::string const& path, OpenOptions const& options) noexcept {
     if (path == IN_MEMORY) {
-        std::cout << "Database in memory can't be opened (use create).\n" << std::flush;
+        logger::warning("Database in memory can't be opened (use create).");
         return false;
     }
+    return open_with(path, options, true);
+}
 
-    auto const flags = read_only ? SQLITE_READONLY : SQLITE_OPEN_READWRITE;
-    if (SQLITE_OK == sqlite3_open_v2(path.c_str(), &db_, flags, nullptr))
-        return true;
+// Open the connection and apply the options.
+// The connection is kept only if all options were applied.
+bool SQLite::open_with(std::string const& path, OpenOptions const& options, bool const log_error) noexcept {
+    if (db_) {
+        logger::warning("Database is already opened!");
+        return false;
+    }
+    if (SQLITE_OK == sqlite3_open_v2(path.c_str(), &db_, options.flags(), nullptr)) {
+        if (options.apply(db_))
+            return true;
+    }
+    else if (log_error)
+        LOG_ERROR(db_);
 
-    if (expected_success) LOG_ERROR(db_);
+    sqlite3_close_v2(db_);
     db_ = nullptr;
     return {};
 }
 
+// Open the database file copied to memory.
+bool SQLite::open_in_memory(std::string const& path, bool const read_only, BackupOptions const& options) noexcept {
+    if (db_) {
+        logger::warning("Database is already opened!");
+        return false;
+    }
+    if (!fs::exists(path)) {
+        logger::error("The file {} does not exist.", path);
+        return false;
+    }
+    if (!open_with(IN_MEMORY, OpenOptions{.create = true}, true))
+        return false;
+    if (restore(path, options)) {
+        if (!read_only || exec("PRAGMA query_only = ON"))
+            return true;
+    }
+    close();
+    return false;
+}
+
+// Copy the database to the file.
+std::optional<BackupProgress> SQLite::backup(std::string const& path, BackupOptions const& options) const noexcept {
+    if (!db_) {
+        logger::warning("Database is not opened.");
+        return {};
+    }
+    sqlite3* destination{};
+    std::optional<BackupProgress> progress{};
+    if (SQLITE_OK == sqlite3_open_v2(path.c_str(), &destination, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr))
+        progress = Backup(db_, destination, options).exec();
+    else
+        LOG_ERROR(destination);
+    sqlite3_close_v2(destination);
+    return progress;
+}
+
+// Replace the content of the database with the content of the file.
+std::optional<BackupProgress> SQLite::restore(std::string const& path, BackupOptions const& options) const noexcept {
+    if (!db_) {
+        logger::warning("Database is not opened.");
+        return {};
+    }
+    sqlite3* source{};
+    std::optional<BackupProgress> progress{};
+    if (SQLITE_OK == sqlite3_open_v2(path.c_str(), &source, SQLITE_OPEN_READONLY, nullptr)) {
+        // Cached statements refer to the old schema.
+        cache_.clear();
+        progress = Backup(source, db_, options).exec();
+    }
+    else
+        LOG_ERROR(source);
+    sqlite3_close_v2(source);
+    return progress;
+}
+
+// Insert all rows of the result to the table.
+std::optional<std::vector<i64>> SQLite::insert_result(std::string const& table, Result const& result, BulkOptions const& options) const {
+    if (result.empty())
+        return std::vector<i64>{};
+
+    auto [names, _] = result.cbegin()->split();
+    std::ranges::sort(names);
+    auto const quoted = names
+        | rng::views::transform([](auto const& name) { return shared::quote_identifier(name); })
+        | rng::to<std::vector>();
+    auto const placeholders = std::vector<std::string>(names.size(), "?");
+    auto const query = std::format("INSERT INTO {} ({}) VALUES ({})", shared::quote_identifier(table), shared::join(quoted), shared::join(placeholders));
+
+    auto it = result.cbegin();
+    return insert_many(query, [&](std::vector<Value>& values) {
+        if (it == result.cend())
+            return false;
+        for (auto const& name : names) {
+            if (auto const field = (*it)[name])
+                values.push_back(field->value());
+            else
+                values.emplace_back();
+        }
+        ++it;
+        return true;
+    }, options);
+}
+
+bool SQLite::export_arrow(Query const& query, fs::path const& path, size_t const rows_per_batch) const {
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    if (!file) {
+        logger::error("The file {} can't be created.", path.string());
+        return {};
+    }
+    return export_arrow(query, [&file](std::span<const char> const bytes) {
+        return static_cast<bool>(file.write(bytes.data(), static_cast<std::streamsize>(bytes.size())));
+    }, rows_per_batch) && file.flush();
+}
+
 // Create a new database file.
-bool SQLite::create(std::string const& path, std::function<bool(SQLite const&)> const& fn, bool overwrite) noexcept {
+bool SQLite::create(std::string const& path, std::function<bool(SQLite const&)> const& fn, bool const overwrite) noexcept {
+    return create(path, fn, OpenOptions{}, overwrite);
+}
+
+// Create a new database file, the connection is opened with given options.
+bool SQLite::create(std::string const& path, std::function<bool(SQLite const&)> const& fn, OpenOptions const& options, bool const overwrite) noexcept {
     if (db_) {
-        std::cout << "Database is already opened\n" << std::flush;
+        logger::warning("Database is already opened");
         return {};
     }
     if (!fn) {
-        std::cout << "Operations to be performed on created database were not specified\n" << std::flush;
+        logger::warning("Operations to be performed on created database were not specified");
         return {};
     }
 
@@ -82,19 +200,19 @@ bool SQLite::create(std::string const& path, std::function<bool(SQLite const&)>
         if (fs::exists(path, err)) {
             if (overwrite) { // is this what the user wants?
                 if (!fs::remove(path)) {
-                    std::cerr << "database file could not be deleted\n" << std::flush;
+                    logger::error("database file could not be deleted");
                     return false;
                 }
             }
         }
         else if (err)
-            std::cerr << std::format("database already exist {}\n", err.message()) << std::flush;
+            logger::error("database already exist {}", err.message());
     }
 
-    constexpr auto flags = SQLITE_OPEN_CREATE | SQLITE_OPEN_READWRITE;
-    if (SQLITE_OK == sqlite3_open_v2(path.c_str(), &db_, flags, nullptr))
+    auto create_options = options;
+    create_options.create = true;
+    create_options.read_only = false;
+    if (open_with(path, create_options, true))
         return fn(*this);
-
-    LOG_ERROR(db_);
     return {};
 }
@@ -29,8 +29,21 @@
 #include "types.h"
 #include "query.h"
 #include "stmt.h"
+#include "stmt_cache.h"
+#include "cursor.h"
+#include "bulk.h"
+#include "loader.h"
+#include "arrow.h"
+#include "backup.h"
+#include "transaction.h"
+#include "mapping.h"
+#include "static_query.h"
+#include "async.h"
+#include "options.h"
 #include <array>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <sqlite3.h>
 
 class SQLite {
@@ -39,6 +52,13 @@ class SQLite {
         0x6f, 0x72, 0x6d, 0x61, 0x74, 0x20, 0x33, 0x00
     };
     sqlite3 *db_ = nullptr;
+    /// Prepared statements reused between calls (keyed by the query text).
+    mutable StmtCache cache_{};
+    mutable TransactionStats tx_stats_{};
+    /// Executors of asynchronous (coroutine) operations.
+    mutable std::mutex executor_mutex_;
+    mutable std::shared_ptr<Executor> executor_{};
+    std::shared_ptr<Executor> resume_executor_{};
 public:
     static constexpr i64 INVALID_ROWID = -1;
     static inline Str IN_MEMORY = ":memory:";
@@ -60,11 +80,36 @@ public:
     }
     bool close() noexcept;
     bool open(std::string const& path, bool expected_success = false, bool read_only = false) noexcept;
+    /// Open with flags and PRAGMAs of the options (e.g. OpenOptions::read_heavy()).
+    /// The database stays closed if any of them can't be applied.
+    bool open(std::string const& path, OpenOptions const& options) noexcept;
     bool create(std::string const&  path, std::function<bool(SQLite const&)> const& fn, bool overwrite = false) noexcept;
+    bool create(std::string const&  path, std::function<bool(SQLite const&)> const& fn, OpenOptions const& options, bool overwrite = false) noexcept;
+    /// Open a copy of the database file in memory (the file is read once, queries don't touch the disk).
+    /// With 'read_only' the connection refuses writes (PRAGMA query_only), e.g. for hot read-only serving.
+    bool open_in_memory(std::string const& path, bool read_only = true, BackupOptions const& options = {.pages_per_step = -1, .sleep = {}}) noexcept;
+    /// Values of the options as reported by SQLite (std::nullopt if the database is closed).
+    [[nodiscard]] std::optional<OpenOptions::Effective> effective_options() const noexcept {
+        return OpenOptions::effective(db_);
+    }
+
+    //------- BACKUP ----------
+    /// Copy the database to the file (created or overwritten) while the database stays in use.
+    [[nodiscard]] std::optional<BackupProgress> backup(std::string const& path, BackupOptions const& options = {}) const noexcept;
+    /// Replace the content of the database with the content of the file.
+    [[nodiscard]] std::optional<BackupProgress> restore(std::string const& path, BackupOptions const& options = {}) const noexcept;
+
+    //------- STATEMENT CACHE ----------
+    [[nodiscard]] StmtCache::Stats cache_stats() const noexcept {
+        return cache_.stats();
+    }
+    void set_cache_capacity(size_t const capacity) const noexcept {
+        cache_.set_capacity(capacity);
+    }
 
     //------- EXEC ----------
     [[nodiscard]] bool exec(Query const& query) const {
-       return Stmt(db_).exec(query);
+       return Stmt(db_, &cache_).exec(query);
     }
     template<typename... T>
     bool exec(std::string const& query_str, T... args) const {
@@ -73,7 +118,7 @@ public:
 
     //------- INSERT ----------
     [[nodiscard]] i64 insert(Query const& query) const {
-        if (Stmt stmt(db_); stmt.exec(query))
+        if (Stmt stmt(db_, &cache_); stmt.exec(query))
             return sqlite3_last_insert_rowid(db_);;
         return INVALID_ROWID;
     }
@@ -82,9 +127,135 @@ public:
         return insert(Query{query_str, args...});
     }
 
+    //------- ASYNC (coroutines) ----------
+    /// Operations are run on the executor of the connection (a dedicated thread by default)
+    /// and the awaiting coroutine is resumed when they are done.
+    [[nodiscard]] Awaitable<bool> async_exec(Query query) const {
+        return {executor(), resume_executor(), [this, query = std::move(query)] { return exec(query); }};
+    }
+    [[nodiscard]] Awaitable<i64> async_insert(Query query) const {
+        return {executor(), resume_executor(), [this, query = std::move(query)] { return insert(query); }};
+    }
+    [[nodiscard]] Awaitable<bool> async_update(Query query) const {
+        return {executor(), resume_executor(), [this, query = std::move(query)] { return update(query); }};
+    }
+    [[nodiscard]] Awaitable<std::optional<Result>> async_select(Query query) const {
+        return {executor(), resume_executor(), [this, query = std::move(query)] { return select(query); }};
+    }
+    /// Fetch the next row of the cursor (the cursor must be created by this connection).
+    [[nodiscard]] Awaitable<std::optional<Row>> async_next(Cursor& cursor) const {
+        return {executor(), resume_executor(), [&cursor] { return cursor.next(); }};
+    }
+
+    /// Replace the executor running asynchronous operations (e.g. with a thread pool).
+    void set_executor(std::shared_ptr<Executor> executor) noexcept {
+        std::lock_guard lock{executor_mutex_};
+        executor_ = std::move(executor);
+    }
+    /// Set the executor on which awaiting coroutines are resumed (e.g. the caller's event loop).
+    /// Without it, coroutines are resumed on the thread that did the work.
+    void set_resume_executor(std::shared_ptr<Executor> executor) noexcept {
+        std::lock_guard lock{executor_mutex_};
+        resume_executor_ = std::move(executor);
+    }
+
+    //------- STATIC QUERY ----------
+    template<IsStaticQuery Q>
+    [[nodiscard]] bool exec(Q const& query) const {
+        return static_query::run(db_, &cache_, query, [](sqlite3_stmt*) {});
+    }
+    template<IsStaticQuery Q>
+    [[nodiscard]] i64 insert(Q const& query) const {
+        if (static_query::run(db_, &cache_, query, [](sqlite3_stmt*) {}))
+            return sqlite3_last_insert_rowid(db_);
+        return INVALID_ROWID;
+    }
+    template<IsStaticQuery Q>
+    [[nodiscard]] std::optional<Result> select(Q const& query) const {
+        Result result{};
+        if (static_query::run(db_, &cache_, query, [&result](sqlite3_stmt* const stmt) {
+            result.add(fetch_row_data(stmt, sqlite3_column_count(stmt)));
+        }))
+            return std::move(result);
+        return {};
+    }
+    template<mapping::Record T, IsStaticQuery Q>
+    [[nodiscard]] std::optional<std::vector<T>> select_as(Q const& query) const {
+        std::vector<T> result{};
+        if (static_query::run(db_, &cache_, query, [&result](sqlite3_stmt* const stmt) {
+            mapping::read_row(stmt, result.emplace_back());
+        }, static_cast<int>(mapping::field_count<T>())))
+            return std::move(result);
+        return {};
+    }
+
+    //------- TRANSACTION ----------
+    /// Begin the transaction, it is rolled back unless committed.
+    [[nodiscard]] std::optional<Transaction> transaction(Transaction::Mode const mode = Transaction::Mode::DEFERRED) const noexcept {
+        return Transaction::begin(db_, mode, &tx_stats_);
+    }
+    /// Begin the savepoint (nested transaction), it is rolled back to unless released.
+    [[nodiscard]] std::optional<Savepoint> savepoint() const noexcept {
+        return Savepoint::begin(db_);
+    }
+    [[nodiscard]] TransactionStats::Snapshot transaction_stats() const noexcept {
+        return tx_stats_.snapshot();
+    }
+
+    //------- INSERT (struct or tuple) ----------
+    /// Members of the record are bound to placeholders in order of declaration.
+    template<mapping::Record T>
+    [[nodiscard]] i64 insert(std::string const& query_str, T const& obj) const {
+        return mapping::insert(db_, &cache_, query_str, obj, INVALID_ROWID);
+    }
+
+    //------- INSERT MANY ----------
+    /// Insert all rows from the source with one prepared statement, in transactions.
+    /// Returns rowids of inserted rows.
+    [[nodiscard]] std::optional<std::vector<i64>> insert_many(std::string const& query_str, RowSource const& next, BulkOptions const& options = {}) const {
+        return BulkInsert(db_, &cache_, &tx_stats_, options).exec(query_str, next);
+    }
+    /// Insert a range of rows, every row is a tuple (or a vector of Values) of the query arguments.
+    template<std::ranges::input_range R>
+    [[nodiscard]] std::optional<std::vector<i64>> insert_many(std::string const& query_str, R&& rows, BulkOptions const& options = {}) const {
+        auto it = std::ranges::begin(rows);
+        auto const end = std::ranges::end(rows);
+        return insert_many(query_str, [&it, &end](std::vector<Value>& values) {
+            if (it == end)
+                return false;
+            if constexpr (std::same_as<std::ranges::range_value_t<R>, std::vector<Value>>)
+                values = *it;
+            else
+                std::apply([&values](auto const&... args) {
+                    (..., values.emplace_back(args));
+                }, *it);
+            ++it;
+            return true;
+        }, options);
+    }
+    /// Insert all rows of the result to the table (columns are taken from the first row).
+    [[nodiscard]] std::optional<std::vector<i64>> insert_result(std::string const& table, Result const& result, BulkOptions const& options = {}) const;
+
+    //------- LOAD (CSV / NDJSON file) ----------
+    /// Load the file to the table, records are parsed in parallel and inserted in file order.
+    /// Returns the final progress (rows, bytes, throughput).
+    [[nodiscard]] std::optional<LoadProgress> load(std::string const& table, fs::path const& path, LoadOptions const& options = {}) const {
+        return FileLoader(db_, &cache_, &tx_stats_, options).exec(table, path);
+    }
+
+    //------- IMPORT (Arrow IPC stream) ----------
+    /// Insert all record batches of the stream to the table (columns are the fields of the stream).
+    /// Returns the number of inserted rows.
+    [[nodiscard]] std::optional<u64> import_arrow(std::string const& table, std::span<const char> bytes, BulkOptions const& options = {}) const {
+        return ipc::ArrowImport(db_, &cache_, &tx_stats_, options).exec(table, bytes);
+    }
+    [[nodiscard]] std::optional<u64> import_arrow(std::string const& table, fs::path const& path, BulkOptions const& options = {}) const {
+        return ipc::ArrowImport(db_, &cache_, &tx_stats_, options).exec(table, path);
+    }
+
     //------- UPDATE ----------
     [[nodiscard]] bool update(Query const& query) const {
-        return Stmt(db_).exec(query);
+        return Stmt(db_, &cache_).exec(query);
     }
     template<typename... T>
     bool update(std::string const& query_str, T... args ) const {
@@ -93,16 +264,85 @@ public:
 
     //------- SELECT ----------
     [[nodiscard]] std::optional<Result> select(Query const& query) const {
-        return Stmt(db_).exec_with_result(query);
+        return Stmt(db_, &cache_).exec_with_result(query);
     }
     template<typename... T>
     std::optional<Result> select(std::string const& query_str, T... args ) const {
         return select(Query{query_str, args...});
     }
 
+    //------- SELECT (to structs or tuples) ----------
+    /// Columns are read to members of T in order of declaration.
+    template<mapping::Record T>
+    [[nodiscard]] std::optional<std::vector<T>> select_as(Query const& query) const {
+        return mapping::select_as<T>(db_, &cache_, query);
+    }
+    template<mapping::Record T, typename... A>
+    std::optional<std::vector<T>> select_as(std::string const& query_str, A... args) const {
+        return select_as<T>(Query{query_str, args...});
+    }
+
+    //------- FOR EACH (borrowed rows) ----------
+    /// Every row is passed to the callback as a view of SQLite's buffers (valid only in the callback).
+    /// The callback returns false to stop the iteration.
+    bool for_each(Query const& query, std::function<bool(RowView const&)> const& fn) const {
+        return Stmt(db_, &cache_).for_each(query, fn);
+    }
+    template<typename... T>
+    bool for_each(std::string const& query_str, std::function<bool(RowView const&)> const& fn, T... args) const {
+        return for_each(Query{query_str, args...}, fn);
+    }
+
+    //------- SELECT (column by column) ----------
+    [[nodiscard]] std::optional<ColumnarResult> select_columnar(Query const& query) const {
+        return Stmt(db_, &cache_).exec_with_columnar_result(query);
+    }
+    template<typename... T>
+    std::optional<ColumnarResult> select_columnar(std::string const& query_str, T... args) const {
+        return select_columnar(Query{query_str, args...});
+    }
+
+    //------- EXPORT (Arrow IPC stream) ----------
+    /// Rows of the query are written to the sink as Arrow record batches of up to 'rows_per_batch' rows,
+    /// while SQLite steps the statement (the whole result is never in memory).
+    bool export_arrow(Query const& query, StreamSink const& sink, size_t const rows_per_batch = 65'536) const {
+        ipc::ArrowWriter writer{sink};
+        return Stmt(db_, &cache_).for_each_batch(query, rows_per_batch, [&writer](ColumnarResult&& batch) {
+            return writer.write(batch);
+        }) && writer.finish();
+    }
+    /// Rows of the query are written to the file (Arrow IPC stream, *.arrows).
+    bool export_arrow(Query const& query, fs::path const& path, size_t rows_per_batch = 65'536) const;
+
+    //------- QUERY (lazy SELECT) ----------
+    /// Rows are fetched one by one while the returned cursor is iterated.
+    [[nodiscard]] std::optional<Cursor> query(Query query) const {
+        return Cursor::open(db_, &cache_, std::move(query));
+    }
+    template<typename... T>
+    std::optional<Cursor> query(std::string const& query_str, T... args) const {
+        return query(Query{query_str, args...});
+    }
+
 private:
+    friend class ConnectionPool;
+
+    /// Executor of the connection, the dedicated thread is started with the first use.
+    std::shared_ptr<Executor> executor() const {
+        std::lock_guard lock{executor_mutex_};
+        if (!executor_)
+            executor_ = std::make_shared<ThreadExecutor>();
+        return executor_;
+    }
+    std::shared_ptr<Executor> resume_executor() const {
+        std::lock_guard lock{executor_mutex_};
+        return resume_executor_;
+    }
+
     SQLite() {
         sqlite3_initialize();
     }
+    /// Open database with the options (errors of sqlite3_open_v2 are logged if log_error).
+    bool open_with(std::string const& path, OpenOptions const& options, bool log_error) noexcept;
 };
 
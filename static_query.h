@@ -0,0 +1,109 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include "shared.h"
+#include "mapping.h"
+#include "stmt.h"
+#include "stmt_cache.h"
+#include "result.h"
+#include "logger.h"
+#include "metrics.h"
+#include <algorithm>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <sqlite3.h>
+
+/// String literal usable as a template argument.
+template<size_t N>
+struct FixedString {
+    char data[N]{};
+
+    constexpr FixedString(char const (&str)[N]) noexcept {
+        std::copy_n(str, N, data);
+    }
+    [[nodiscard]] constexpr std::string_view view() const noexcept {
+        return {data, N - 1};
+    }
+};
+
+/// Query with the SQL text known at compile time. \n
+/// The number of placeholders is checked at compile time and arguments are kept
+/// in a tuple (no Value boxing, no allocation). The statement is prepared once per
+/// connection and found in the statement cache without building a key string.
+template<FixedString SQL, typename... Args>
+class StaticQuery {
+    std::tuple<Args...> args_;
+public:
+    static constexpr std::string_view sql = SQL.view();
+    static_assert(shared::placeholder_count(sql) == sizeof...(Args),
+                  "The number of placeholders and arguments does not match");
+
+    explicit StaticQuery(Args... args) : args_{std::move(args)...} {}
+
+    [[nodiscard]] std::tuple<Args...> const& args() const noexcept {
+        return args_;
+    }
+};
+
+template<typename T>
+struct is_static_query : std::false_type {};
+template<FixedString SQL, typename... Args>
+struct is_static_query<StaticQuery<SQL, Args...>> : std::true_type {};
+template<typename T>
+concept IsStaticQuery = is_static_query<T>::value;
+
+namespace static_query {
+    /// Bind the query arguments, step the statement and call 'fn' for every row.
+    /// 'columns' is the expected number of result columns (-1 - any).
+    /// Returns false on error.
+    template<IsStaticQuery Q, typename F>
+    bool run(sqlite3* const db, StmtCache* const cache, Q const& query, F&& fn, int const columns = -1) {
+        auto const stmt = cache->acquire(db, Q::sql);
+        if (!stmt)
+            return {};
+
+        auto ok = mapping::bind_row(stmt, query.args());
+        if (ok && columns >= 0 && sqlite3_column_count(stmt) != columns) {
+            logger::error("The number of columns and members does not match ({}, {})", sqlite3_column_count(stmt), columns);
+            cache->release(Q::sql, stmt);
+            return {};
+        }
+        if (ok) {
+            int rc;
+            while (SQLITE_ROW == (rc = metrics::step(stmt)))
+                fn(stmt);
+            ok = rc == SQLITE_DONE;
+        }
+        if (!ok)
+            LOG_ERROR(db);
+        cache->release(Q::sql, stmt);
+        return ok;
+    }
+}
@@ -29,17 +29,19 @@
 #include "stmt.h"
 #include "logger.h"
 #include "row.h"
+#include "row_view.h"
 #include "value.h"
-
-/*------- forward declarations:
--------------------------------------------------------------------*/
-Row fetch_row_data(sqlite3_stmt* stmt, int column_count) noexcept;
-bool bind2stmt(sqlite3_stmt* stmt, std::vector<Value> const& args) noexcept;
-bool bind_at(sqlite3_stmt* stmt, int idx, Value const& v) noexcept;
+#include "metrics.h"
 
 Stmt::~Stmt() {
     if (stmt_) {
-        if (SQLITE_OK == sqlite3_finalize(stmt_)) {
+        // The statement left after an error belongs to the cache, it is reset and given back.
+        if (cache_) {
+            cache_->release(sql_, stmt_);
+            stmt_ = nullptr;
+            return;
+        }
+        if (SQLITE_OK == metrics::finalize(stmt_)) {
             stmt_ = nullptr;
             return;
         }
@@ -48,14 +50,13 @@ Stmt::~Stmt() {
 }
 
 bool Stmt::exec(Query const &query) {
+    metrics::Timer const timer{metrics::EXEC, query.cmd()};
     if (query.valid()) {
-        if (SQLITE_OK == sqlite3_prepare_v2(db_, query.c_str(), -1, &stmt_, nullptr)) {
+        if (prepare(query.cmd())) {
             if (bind2stmt(stmt_, query.values())) {
-                if (SQLITE_DONE == sqlite3_step(stmt_)) {
-                    if (SQLITE_OK == sqlite3_finalize(stmt_)) {
-                        stmt_ = nullptr;
+                if (SQLITE_DONE == metrics::step(stmt_)) {
+                    if (release(query.cmd()))
                         return true;
-                    }
                 }
             }
         }
@@ -65,15 +66,16 @@ bool Stmt::exec(Query const &query) {
 }
 
 std::optional<Result> Stmt::exec_with_result(Query const& query) {
+    metrics::Timer const timer{metrics::SELECT, query.cmd()};
     if (!query.valid()) {
         return {};
     }
 
     Result result{};
-    if (SQLITE_OK == sqlite3_prepare_v2(db_, query.c_str(), -1, &stmt_, nullptr)) {
+    if (prepare(query.cmd())) {
         if (bind2stmt(stmt_, query.values())) {
             if (auto n = sqlite3_column_count(stmt_)) {
-                while (SQLITE_ROW == sqlite3_step(stmt_)) {
+                while (SQLITE_ROW == metrics::step(stmt_)) {
                     if (auto row = fetch_row_data(stmt_, n); !row.empty()) {
                         result.add(std::move(row));
                     }
@@ -83,16 +85,166 @@ std::optional<Result> Stmt::exec_with_result(Query const& query) {
     }
 
     if (SQLITE_DONE == sqlite3_errcode(db_)) {
-        if (SQLITE_OK == sqlite3_finalize(stmt_)) {
-            stmt_ = nullptr;
+        if (release(query.cmd()))
             return std::move(result);
+    }
+
+    LOG_ERROR(db_);
+    return {};
+}
+
+std::optional<ColumnarResult> Stmt::exec_with_columnar_result(Query const& query) {
+    metrics::Timer const timer{metrics::SELECT, query.cmd()};
+    if (!query.valid()) {
+        return {};
+    }
+
+    std::optional<ColumnarResult> result{};
+    if (prepare(query.cmd())) {
+        if (bind2stmt(stmt_, query.values())) {
+            // The schema is read once, before the first step.
+            Schema schema{};
+            auto const n = sqlite3_column_count(stmt_);
+            for (auto i = 0; i < n; ++i) {
+                auto const declared_type = sqlite3_column_decltype(stmt_, i);
+                schema.add(sqlite3_column_name(stmt_, i), declared_type ? declared_type : "");
+            }
+            result = ColumnarResult{std::move(schema)};
+            if (n) {
+                while (SQLITE_ROW == metrics::step(stmt_))
+                    result->add(stmt_);
+            }
         }
     }
 
+    if (result && SQLITE_DONE == sqlite3_errcode(db_)) {
+        if (release(query.cmd()))
+            return result;
+    }
+
     LOG_ERROR(db_);
     return {};
 }
 
+bool Stmt::for_each_batch(Query const& query, size_t const rows, std::function<bool(ColumnarResult&&)> const& fn) {
+    metrics::Timer const timer{metrics::SELECT, query.cmd()};
+    if (!query.valid() || rows == 0) {
+        return {};
+    }
+
+    auto completed = false;
+    if (prepare(query.cmd())) {
+        if (bind2stmt(stmt_, query.values())) {
+            Schema schema{};
+            auto const n = sqlite3_column_count(stmt_);
+            for (auto i = 0; i < n; ++i) {
+                auto const declared_type = sqlite3_column_decltype(stmt_, i);
+                schema.add(sqlite3_column_name(stmt_, i), declared_type ? declared_type : "");
+            }
+            auto const shared = std::make_shared<Schema const>(std::move(schema));
+            ColumnarResult batch{shared};
+            batch.reserve(rows);
+            auto stopped = false;
+            auto delivered = false;
+            int rc;
+            while (SQLITE_ROW == (rc = metrics::step(stmt_))) {
+                if (batch.add(stmt_).size() == rows) {
+                    delivered = true;
+                    if (!fn(std::move(batch))) {
+                        stopped = true;
+                        break;
+                    }
+                    batch = ColumnarResult{shared};
+                    batch.reserve(rows);
+                }
+            }
+            // The last (partial) batch. A query without rows still passes one empty batch
+            // so the callback always learns the schema.
+            if (!stopped && rc == SQLITE_DONE && (!batch.empty() || !delivered))
+                fn(std::move(batch));
+            completed = stopped || rc == SQLITE_DONE;
+        }
+    }
+
+    if (completed) {
+        if (release(query.cmd()))
+            return true;
+    }
+
+    LOG_ERROR(db_);
+    return {};
+}
+
+bool Stmt::for_each(Query const& query, std::function<bool(RowView const&)> const& fn) {
+    metrics::Timer const timer{metrics::SELECT, query.cmd()};
+    if (!query.valid()) {
+        return {};
+    }
+
+    auto completed = false;
+    if (prepare(query.cmd())) {
+        if (bind2stmt(stmt_, query.values())) {
+            RowView const row{stmt_};
+            int rc;
+            while (SQLITE_ROW == (rc = metrics::step(stmt_)))
+                if (!fn(row))
+                    break;
+            // Stopping by the callback is not an error.
+            completed = rc == SQLITE_ROW || rc == SQLITE_DONE;
+        }
+    }
+
+    if (completed) {
+        if (release(query.cmd()))
+            return true;
+    }
+
+    LOG_ERROR(db_);
+    return {};
+}
+
+bool Stmt::prepare(std::string const& sql) noexcept {
+    if (cache_) {
+        stmt_ = cache_->acquire(db_, sql);
+        sql_ = sql;
+        return stmt_ != nullptr;
+    }
+    return SQLITE_OK == metrics::prepare(db_, sql, 0, &stmt_);
+}
+
+bool Stmt::release(std::string const& sql) noexcept {
+    if (cache_) {
+        cache_->release(sql, stmt_);
+        stmt_ = nullptr;
+        return true;
+    }
+    if (SQLITE_OK == metrics::finalize(stmt_)) {
+        stmt_ = nullptr;
+        return true;
+    }
+    return {};
+}
+
+Value RowView::value(int const i) const {
+    switch (kind(i)) {
+        case Value::INTEGER:
+            return Value{integer(i)};
+        case Value::DOUBLE:
+            return Value{real(i)};
+        case Value::STRING:
+            return Value{text(i)};
+        case Value::VECTOR: {
+            auto const data = blob(i);
+            return Value{std::vector<u8>{data.begin(), data.end()}};
+        }
+        default:
+            return {};
+    }
+}
+
+Row RowView::to_row() const {
+    return fetch_row_data(stmt_, column_count_);
+}
 
 //*******************************************************************
 //*                                                                 *
@@ -137,32 +289,47 @@ Row fetch_row_data(sqlite3_stmt* const stmt, int const column_count) noexcept {
     return row;
 }
 
-bool bind2stmt(sqlite3_stmt* const stmt, std::vector<Value> const& args) noexcept {
+bool bind2stmt(sqlite3_stmt* const stmt, std::vector<Value> const& args, sqlite3_destructor_type const destructor) noexcept {
     if (!args.empty()) {
         auto idx = 0;
         for (auto const& v: args)
-            if (!bind_at(stmt, ++idx, v))
+            if (!bind_at(stmt, ++idx, v, destructor))
                 return {};
     }
     return true;
 }
 
-bool bind_at(sqlite3_stmt* const stmt, int const idx, Value const& v) noexcept {
-    switch (v.index()) {
+bool bind_at(sqlite3_stmt* const stmt, int const idx, Value const& v, sqlite3_destructor_type const destructor) noexcept {
+    switch (v.kind()) {
         case Value::MONOSTATE:
             return SQLITE_OK == sqlite3_bind_null(stmt, idx);
         case Value::INTEGER:
+            metrics::add(metrics::BYTES_BOUND, sizeof(i64));
             return SQLITE_OK == sqlite3_bind_int64(stmt, idx, static_cast<sqlite3_int64>(v.value<i64>()));
         case Value::DOUBLE:
+            metrics::add(metrics::BYTES_BOUND, sizeof(f64));
             return SQLITE_OK == sqlite3_bind_double(stmt, idx, v.value<f64>());
-        case Value::STRING: {
-            auto const text = v.value<std::string>();
-            return SQLITE_OK == sqlite3_bind_text(stmt, idx, text.c_str(), -1, SQLITE_TRANSIENT); }
-        case Value::VECTOR: {
-            auto const vec = v.value<std::vector<u8>>();
-            auto const n{ static_cast<int>(vec.size())};
-            return SQLITE_OK == sqlite3_bind_blob(stmt, idx, vec.data(), n, SQLITE_TRANSIENT); }
+        case Value::STRING:
+            return bind_at(stmt, idx, v.text(), destructor);
+        case Value::VECTOR:
+            return bind_at(stmt, idx, v.blob(), destructor);
         default:
             return false;
     }
 }
+
+bool bind_at(sqlite3_stmt* const stmt, int const idx, std::string_view const text, sqlite3_destructor_type const destructor) noexcept {
+    metrics::add(metrics::BYTES_BOUND, text.size());
+    // The text is passed with its size, so SQLite does not look for the terminating zero.
+    // A default-constructed view has no data, SQLite would bind it as NULL instead of empty text.
+    auto const data = text.data() ? text.data() : "";
+    return SQLITE_OK == sqlite3_bind_text64(stmt, idx, data, text.size(), destructor, SQLITE_UTF8);
+}
+
+bool bind_at(sqlite3_stmt* const stmt, int const idx, std::span<const u8> const blob, sqlite3_destructor_type const destructor) noexcept {
+    metrics::add(metrics::BYTES_BOUND, blob.size());
+    // An empty vector (or span) has no data either, it is bound as an empty blob, not NULL.
+    static constexpr u8 empty{};
+    auto const data = blob.data() ? blob.data() : &empty;
+    return SQLITE_OK == sqlite3_bind_blob64(stmt, idx, data, blob.size(), destructor);
+}
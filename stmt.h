@@ -27,26 +27,67 @@
 /*------- include files:
 -------------------------------------------------------------------*/
 #include <optional>
+#include <functional>
 #include <sqlite3.h>
 #include "query.h"
 #include "result.h"
+#include "columnar.h"
+#include "stmt_cache.h"
+#include "row_view.h"
 
 class Stmt {
     sqlite3* db_{};
+    StmtCache* cache_{};
     sqlite3_stmt* stmt_{};
+    /// SQL of the statement taken from the cache (the query outlives the Stmt).
+    std::string_view sql_{};
 public:
     Stmt() = delete;
     ~Stmt();
-    Stmt(Stmt const&) = default;
-    Stmt(Stmt&&) = default;
-    Stmt& operator=(Stmt const&) = default;
-    Stmt& operator=(Stmt&&) = default;
+    /// No Copy (the statement handle has a single owner)
+    Stmt(Stmt const&) = delete;
+    Stmt& operator=(Stmt const&) = delete;
+    /// No Move
+    Stmt(Stmt&&) = delete;
+    Stmt& operator=(Stmt&&) = delete;
 
-    explicit Stmt(sqlite3* db) : db_(db) {}
+    /// Statements are prepared for every query and finalized after it,
+    /// unless a cache is given, then they are taken from it and returned to it.
+    explicit Stmt(sqlite3* db, StmtCache* cache = nullptr) : db_(db), cache_(cache) {}
 
     /// Execute query without return data.
     bool exec(Query const& query);
 
     /// Execute a query that returns the result
     std::optional<Result> exec_with_result(Query const& query);
+
+    /// Execute a query and pass every row to the callback without copying it.
+    /// The callback returns false to stop the iteration.
+    bool for_each(Query const& query, std::function<bool(RowView const&)> const& fn);
+
+    /// Execute a query that returns the result stored column by column.
+    std::optional<ColumnarResult> exec_with_columnar_result(Query const& query);
+    /// Rows are passed to the callback in columnar batches of up to 'rows' rows
+    /// (all batches share one schema). The callback returns false to stop.
+    bool for_each_batch(Query const& query, size_t rows, std::function<bool(ColumnarResult&&)> const& fn);
+
+private:
+    /// Take the prepared statement for the query (from the cache if possible).
+    bool prepare(std::string const& sql) noexcept;
+    /// Give the statement back to the cache or finalize it.
+    bool release(std::string const& sql) noexcept;
 };
+
+/*------- helper functions:
+-------------------------------------------------------------------*/
+/// Create a Row from the current row of the statement.
+Row fetch_row_data(sqlite3_stmt* stmt, int column_count) noexcept;
+/// Bind all arguments to the statement (placeholders are numbered from 1).
+/// Text and blobs are not copied by default (SQLITE_STATIC), so the arguments
+/// must live until the statement is stepped and its bindings cleared or replaced.
+/// Pass SQLITE_TRANSIENT if that is not the case.
+bool bind2stmt(sqlite3_stmt* stmt, std::vector<Value> const& args, sqlite3_destructor_type destructor = SQLITE_STATIC) noexcept;
+/// Bind one argument to the placeholder with index 'idx'.
+bool bind_at(sqlite3_stmt* stmt, int idx, Value const& v, sqlite3_destructor_type destructor = SQLITE_STATIC) noexcept;
+bool bind_at(sqlite3_stmt* stmt, int idx, std::string_view text, sqlite3_destructor_type destructor = SQLITE_STATIC) noexcept;
+bool bind_at(sqlite3_stmt* stmt, int idx, std::span<const u8> blob, sqlite3_destructor_type destructor = SQLITE_STATIC) noexcept;
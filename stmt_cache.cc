@@ -0,0 +1,185 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "stmt_cache.h"
+#include "logger.h"
+#include "metrics.h"
+#include <algorithm>
+
+/********************************************************************
+*                                                                   *
+*                          A C Q U I R E                            *
+*                                                                   *
+********************************************************************/
+
+auto StmtCache::
+acquire(sqlite3* const db, std::string_view const sql, bool const log_error) noexcept
+-> sqlite3_stmt* {
+    {
+        std::lock_guard lock{mutex_};
+        if (auto const it = index_.find(sql); it != index_.end() && !it->second->in_use) {
+            auto const entry = it->second;
+            entry->in_use = true;
+            lru_.splice(lru_.begin(), lru_, entry);
+            ++stats_.hits;
+            return entry->stmt;
+        }
+        ++stats_.misses;
+    }
+
+    // Statements that will be kept in the cache are prepared as persistent.
+    sqlite3_stmt* stmt{};
+    auto const flags = capacity() ? SQLITE_PREPARE_PERSISTENT : 0;
+    if (SQLITE_OK == metrics::prepare(db, sql, flags, &stmt))
+        return stmt;
+
+    if (log_error)
+        LOG_ERROR(db);
+    return nullptr;
+}
+
+/********************************************************************
+*                                                                   *
+*                          R E L E A S E                            *
+*                                                                   *
+********************************************************************/
+
+auto StmtCache::
+release(std::string_view const sql, sqlite3_stmt* const stmt) noexcept
+-> void {
+    if (!stmt)
+        return;
+
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    std::vector<sqlite3_stmt*> evicted{};
+    {
+        std::lock_guard lock{mutex_};
+        if (auto const it = std::ranges::find(orphans_, stmt); it != orphans_.end()) {
+            // The statement was in use when the cache was cleared.
+            orphans_.erase(it);
+            evicted.push_back(stmt);
+        }
+        else if (auto const it = index_.find(sql); it != index_.end()) {
+            if (it->second->stmt == stmt)
+                // The statement taken from the cache returns to it.
+                it->second->in_use = false;
+            else
+                // The same query is already cached
+                // (the statement was used by two callers at the same time).
+                evicted.push_back(stmt);
+        }
+        else if (capacity_ == 0)
+            evicted.push_back(stmt);
+        else {
+            lru_.push_front(Entry{std::string{sql}, stmt, false});
+            index_.emplace(lru_.front().sql, lru_.begin());
+            evicted = shrink();
+        }
+    }
+    std::ranges::for_each(evicted, metrics::finalize);
+}
+
+/********************************************************************
+*                                                                   *
+*                      C L E A R  /  S H R I N K                    *
+*                                                                   *
+********************************************************************/
+
+auto StmtCache::
+clear() noexcept
+-> void {
+    Lru lru{};
+    {
+        std::lock_guard lock{mutex_};
+        index_.clear();
+        lru.swap(lru_);
+        // Statements still used by a cursor (or another Stmt) can't be finalized now,
+        // they are finalized when they are released.
+        for (auto const& entry : lru)
+            if (entry.in_use)
+                orphans_.push_back(entry.stmt);
+    }
+    for (auto const& entry : lru)
+        if (!entry.in_use)
+            metrics::finalize(entry.stmt);
+}
+
+auto StmtCache::
+shrink() noexcept
+-> std::vector<sqlite3_stmt*> {
+    std::vector<sqlite3_stmt*> evicted{};
+    for (auto it = lru_.end(); lru_.size() > capacity_ && it != lru_.begin(); ) {
+        if ((--it)->in_use)
+            continue;
+        evicted.push_back(it->stmt);
+        index_.erase(it->sql);
+        it = lru_.erase(it);
+        ++stats_.evictions;
+    }
+    return evicted;
+}
+
+/********************************************************************
+*                                                                   *
+*                      P R O P E R T I E S                          *
+*                                                                   *
+********************************************************************/
+
+auto StmtCache::
+set_capacity(size_t const capacity) noexcept
+-> void {
+    std::vector<sqlite3_stmt*> evicted{};
+    {
+        std::lock_guard lock{mutex_};
+        capacity_ = capacity;
+        evicted = shrink();
+    }
+    std::ranges::for_each(evicted, metrics::finalize);
+}
+
+auto StmtCache::
+capacity() const noexcept
+-> size_t {
+    std::lock_guard lock{mutex_};
+    return capacity_;
+}
+
+auto StmtCache::
+size() const noexcept
+-> size_t {
+    std::lock_guard lock{mutex_};
+    return lru_.size();
+}
+
+auto StmtCache::
+stats() const noexcept
+-> Stats {
+    std::lock_guard lock{mutex_};
+    return stats_;
+}
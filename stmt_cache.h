@@ -0,0 +1,103 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <sqlite3.h>
+
+/// Bounded LRU cache of prepared statements keyed by the SQL text.
+/// A handle taken with 'acquire' is marked as used until it is returned with 'release',
+/// so the same handle is never stepped twice at once (the second caller gets a new statement).
+/// Taking and returning a cached statement does not allocate memory.
+class StmtCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    struct Stats {
+        u64 hits{};
+        u64 misses{};
+        u64 evictions{};
+    };
+
+    explicit StmtCache(size_t const capacity = DEFAULT_CAPACITY) : capacity_{capacity} {}
+    ~StmtCache() { clear(); }
+    /// No Copy
+    StmtCache(StmtCache const&) = delete;
+    StmtCache& operator=(StmtCache const&) = delete;
+    /// No Move
+    StmtCache(StmtCache&&) = delete;
+    StmtCache& operator=(StmtCache&&) = delete;
+
+    /// Take the cached statement for 'sql' or prepare a new one.
+    /// Returns nullptr if the statement could not be prepared
+    /// (the error is logged unless 'log_error' is false).
+    [[nodiscard]] sqlite3_stmt* acquire(sqlite3* db, std::string_view sql, bool log_error = true) noexcept;
+
+    /// Reset the statement and put it back to the cache.
+    /// The least recently used statement is finalized if the cache is full.
+    void release(std::string_view sql, sqlite3_stmt* stmt) noexcept;
+
+    /// Finalize all cached statements (must be done before closing the database).
+    /// Statements in use are removed from the cache and finalized when they are released
+    /// (the connection closed with sqlite3_close_v2 lives until then).
+    void clear() noexcept;
+
+    /// Change the number of statements kept in the cache (0 disables caching).
+    void set_capacity(size_t capacity) noexcept;
+
+    [[nodiscard]] size_t capacity() const noexcept;
+    [[nodiscard]] size_t size() const noexcept;
+    [[nodiscard]] Stats stats() const noexcept;
+
+private:
+    struct Entry {
+        std::string sql;
+        sqlite3_stmt* stmt;
+        bool in_use;
+    };
+    using Lru = std::list<Entry>;
+
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    Stats stats_{};
+    /// The front of the list is the most recently used statement.
+    Lru lru_;
+    /// Keys are views of the SQL text stored in the list (list nodes never move).
+    std::unordered_map<std::string_view, Lru::iterator> index_;
+    /// Statements that were in use when the cache was cleared.
+    std::vector<sqlite3_stmt*> orphans_;
+
+    /// Remove the least recently used statements (not in use) exceeding the capacity.
+    /// Evicted statements are returned so that they can be finalized outside the lock.
+    std::vector<sqlite3_stmt*> shrink() noexcept;
+};
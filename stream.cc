@@ -0,0 +1,221 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "stream.h"
+#include "reader.h"
+#include "writer.h"
+#include <limits>
+
+namespace {
+    constexpr char TERMINATOR_MARKER{'E'};
+
+    /// Result of reading a varint of the frame header.
+    enum class Header { OK, MORE, INVALID };
+
+    /// Read the varint, a varint without terminator in its 10 bytes is invalid.
+    Header varint(Reader& r, u64& value) noexcept {
+        auto const before = r.consumed();
+        if (auto const v = r.varint()) {
+            value = *v;
+            return Header::OK;
+        }
+        return (r.consumed() - before) >= wire::MAX_VARINT_SIZE ? Header::INVALID : Header::MORE;
+    }
+
+    /// Size of the frame: the header and 'nbytes' behind it (0 on overflow).
+    size_t total(size_t const header, u64 const nbytes) noexcept {
+        if (nbytes > std::numeric_limits<size_t>::max() - header)
+            return 0;
+        return header + static_cast<size_t>(nbytes);
+    }
+}
+
+/********************************************************************
+*                                                                   *
+*                           W R I T E R                             *
+*                                                                   *
+********************************************************************/
+
+auto ResultStreamWriter::
+push(Row row)
+-> bool {
+    if (failed_ || finished_)
+        return false;
+
+    chunk_bytes_ += row.encoded_size_v2();
+    chunk_.add(std::move(row));
+    ++rows_;
+    if (chunk_.size() >= options_.rows_per_chunk || chunk_bytes_ >= options_.bytes_per_chunk)
+        return flush();
+    return true;
+}
+
+auto ResultStreamWriter::
+push(Cursor& cursor)
+-> bool {
+    while (auto row = cursor.next())
+        if (!push(std::move(*row)))
+            return false;
+    return !cursor.failed();
+}
+
+auto ResultStreamWriter::
+finish()
+-> bool {
+    if (failed_ || finished_)
+        return false;
+    if (!flush())
+        return false;
+
+    std::vector<char> buffer(sizeof(char) + wire::varint_size(rows_));
+    Writer w{buffer};
+    w.put(TERMINATOR_MARKER);
+    w.put_varint(rows_);
+    finished_ = true;
+    if (!sink_(buffer))
+        failed_ = true;
+    return !failed_;
+}
+
+auto ResultStreamWriter::
+flush()
+-> bool {
+    if (chunk_.empty())
+        return true;
+
+    auto const frame = options_.compression
+        ? chunk_.to_compressed_bytes(*options_.compression)
+        : chunk_.to_bytes(wire::V2);
+    chunk_ = {};
+    chunk_bytes_ = 0;
+    if (frame.empty() || !sink_(frame))
+        failed_ = true;
+    return !failed_;
+}
+
+/********************************************************************
+*                                                                   *
+*                           R E A D E R                             *
+*                                                                   *
+********************************************************************/
+
+auto ResultStreamReader::
+feed(std::span<const char> const bytes)
+-> void {
+    // drop the consumed bytes before the buffer grows
+    if (pos_ > 0 && pos_ >= buffer_.size() / 2) {
+        buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(pos_));
+        pos_ = 0;
+    }
+    buffer_.insert(buffer_.end(), bytes.begin(), bytes.end());
+}
+
+auto ResultStreamReader::
+next()
+-> std::optional<Result> {
+    if (done_ || failed_)
+        return {};
+
+    auto const span = std::span<const char>{buffer_}.subspan(pos_);
+    auto const size = frame_size(span);
+    if (size && (*size == 0 || *size > max_frame_size_)) {
+        failed_ = true;
+        return {};
+    }
+    if (!size || span.size() < *size)
+        return {};     // wait for more bytes
+
+    auto const frame = span.first(*size);
+    pos_ += *size;
+    if (frame.front() == TERMINATOR_MARKER) {
+        Reader r{frame.subspan(1)};
+        if (r.varint() == rows_)
+            done_ = true;
+        else
+            failed_ = true;
+        return {};
+    }
+
+    auto [result, nbytes] = Result::from_bytes(frame);
+    if (nbytes != frame.size()) {
+        failed_ = true;
+        return {};
+    }
+    rows_ += result.size();
+    return std::move(result);
+}
+
+auto ResultStreamReader::
+frame_size(std::span<const char> const span) noexcept
+-> std::optional<size_t> {
+    Reader r{span};
+    auto const marker = r.get();
+    if (!marker)
+        return {};
+
+    u64 value{};
+    // compressed: marker, flags, uncompressed size, compressed size, data
+    if (codec::is_compressed(*marker)) {
+        if (codec::codec_bits(*marker) == codec::LEGACY_GZIP) {
+            auto const nbytes = r.get<u32>();
+            if (!nbytes)
+                return {};
+            return r.consumed() + *nbytes;
+        }
+        if (!r.get<u8>())
+            return {};
+        for (auto i = 0; i < 2; ++i) {
+            // uncompressed size, then compressed size
+            if (auto const h = varint(r, value); h != Header::OK)
+                return h == Header::MORE ? std::optional<size_t>{} : 0;
+        }
+        return total(r.consumed(), value);
+    }
+
+    switch (*marker) {
+        case TERMINATOR_MARKER:
+            if (auto const h = varint(r, value); h != Header::OK)
+                return h == Header::MORE ? std::optional<size_t>{} : 0;
+            return r.consumed();
+        case 't': {
+            // V2: marker, version, body size, body
+            if (!r.get<u8>())
+                return {};
+            if (auto const h = varint(r, value); h != Header::OK)
+                return h == Header::MORE ? std::optional<size_t>{} : 0;
+            return total(r.consumed(), value);
+        }
+        case 'T': {
+            auto const nbytes = r.get<u32>();
+            if (!nbytes)
+                return {};
+            return r.consumed() + *nbytes;
+        }
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include "result.h"
+#include "cursor.h"
+#include "codec.h"
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+/// Streaming serialization of big results. \n
+/// The stream is a sequence of self-delimiting chunks, every chunk is a complete V2 Result frame
+/// of some rows (compressed independently if a codec is set). The stream ends with the terminator
+/// frame: marker 'E' and the total number of rows (varint). \n
+/// Nothing limits the size of the stream, the sender writes chunks as soon as the rows are ready
+/// and the receiver decodes them as they arrive.
+struct StreamOptions {
+    /// The chunk is written when it has so many rows ...
+    size_t rows_per_chunk{1'024};
+    /// ... or so many bytes (serialized, uncompressed).
+    size_t bytes_per_chunk{1 << 20};
+    /// Compression of chunks (none by default).
+    std::optional<codec::Options> compression{};
+};
+
+/// Destination of stream bytes (e.g. socket), returns false if the bytes can't be written.
+using StreamSink = std::function<bool(std::span<const char>)>;
+
+class ResultStreamWriter {
+    StreamSink sink_;
+    StreamOptions options_;
+    Result chunk_{};
+    size_t chunk_bytes_{};
+    u64 rows_{};
+    bool finished_{};
+    bool failed_{};
+public:
+    explicit ResultStreamWriter(StreamSink sink, StreamOptions options = {})
+        : sink_{std::move(sink)}, options_{std::move(options)} {}
+    /// No Copy
+    ResultStreamWriter(ResultStreamWriter const&) = delete;
+    ResultStreamWriter& operator=(ResultStreamWriter const&) = delete;
+
+    /// Add the row, the chunk is written when it is full.
+    bool push(Row row);
+    /// Add all rows of the cursor, as the cursor yields them.
+    bool push(Cursor& cursor);
+    /// Write the rest of rows and the terminator frame.
+    bool finish();
+
+    [[nodiscard]] bool failed() const noexcept {
+        return failed_;
+    }
+    /// Number of rows pushed so far.
+    [[nodiscard]] u64 rows() const noexcept {
+        return rows_;
+    }
+
+private:
+    bool flush();
+};
+
+/// Incremental decoder of the stream. \n
+/// Feed it with bytes as they arrive and take the decoded chunks.
+class ResultStreamReader {
+    std::vector<char> buffer_{};
+    size_t pos_{};
+    u64 rows_{};
+    size_t max_frame_size_;
+    bool done_{};
+    bool failed_{};
+public:
+    /// Frames bigger than 'max_frame_size' are treated as errors (the buffer does not grow without limit).
+    explicit ResultStreamReader(size_t const max_frame_size = codec::MAX_FRAME_SIZE) noexcept
+        : max_frame_size_{max_frame_size} {}
+
+    /// Append received bytes.
+    void feed(std::span<const char> bytes);
+    /// Decode the next chunk if it is complete (std::nullopt if more bytes are needed,
+    /// at the end of stream or on error).
+    std::optional<Result> next();
+
+    /// The terminator was read (and the number of rows agrees).
+    [[nodiscard]] bool done() const noexcept {
+        return done_;
+    }
+    [[nodiscard]] bool failed() const noexcept {
+        return failed_;
+    }
+    /// Number of rows decoded so far.
+    [[nodiscard]] u64 rows() const noexcept {
+        return rows_;
+    }
+
+    /// Size of the frame at the beginning of the span
+    /// (std::nullopt if the span does not contain the whole frame header yet,
+    /// 0 if it is not a frame or the header is invalid).
+    static std::optional<size_t> frame_size(std::span<const char> span) noexcept;
+};
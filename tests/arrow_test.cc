@@ -0,0 +1,111 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "../sqlite.h"
+#include <cstdio>
+#include <string_view>
+
+// Arrow IPC stream checks run by ctest:
+//   sqlite_arrow_test export <path>   - writes the stream validated by tests/arrow_validate.py (pyarrow),
+//   sqlite_arrow_test import <path>   - imports tests/data/pyarrow.arrows written by pyarrow.
+
+namespace {
+    int failures{};
+
+    void check(bool const ok, char const* const what) {
+        if (!ok) {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    bool open_database() {
+        return SQLite::self().create(SQLite::IN_MEMORY, [](SQLite const& db) {
+            return db.exec("CREATE TABLE t (id INTEGER, name TEXT, score REAL, data BLOB, misc)");
+        });
+    }
+
+    /// Rows expected by arrow_validate.py, written in batches of 2 rows.
+    int export_stream(fs::path const& path) {
+        auto const& db = SQLite::self();
+        check(db.exec("INSERT INTO t VALUES (1, 'alice', 1.5, x'0102', 7)"), "insert 1");
+        check(db.exec("INSERT INTO t VALUES (2, NULL, NULL, NULL, 8)"), "insert 2");
+        check(db.exec("INSERT INTO t VALUES (3, 'zażółć', -2.25, x'', 9)"), "insert 3");
+        check(db.exec("INSERT INTO t VALUES (NULL, '', 0, x'ff', NULL)"), "insert 4");
+        check(db.export_arrow(Query{"SELECT * FROM t ORDER BY rowid"}, path, 2), "export");
+
+        // The type of 'misc' is chosen by the first batch (INT64), text in a later batch
+        // can't be represented and must fail the export instead of being written as null.
+        check(db.exec("INSERT INTO t VALUES (5, 'e', 1, x'00', 'text')"), "insert 5");
+        std::vector<char> ignored{};
+        auto const ok = db.export_arrow(Query{"SELECT misc FROM t ORDER BY rowid"}, [&ignored](std::span<const char> const bytes) {
+            ignored.insert(ignored.end(), bytes.begin(), bytes.end());
+            return true;
+        }, 2);
+        check(!ok, "export of a value that does not fit the column type fails");
+        return failures;
+    }
+
+    /// The fixture written by arrow_validate.py --write (int32, large_string, float32, binary; batches of 2 rows).
+    int import_stream(fs::path const& path) {
+        auto const& db = SQLite::self();
+        check(db.exec("CREATE TABLE u (a INTEGER, b TEXT, c REAL, d BLOB)"), "create");
+        auto const n = db.import_arrow("u", path);
+        check(n && *n == 3, "import 3 rows");
+
+        auto const result = db.select("SELECT a, b, c, quote(d) AS d FROM u ORDER BY rowid");
+        check(result && result->size() == 3, "select 3 rows");
+        if (!result || result->size() != 3)
+            return failures;
+        auto const& rows = *result;
+        check(rows[0]["a"]->value() == Value{1} && rows[0]["b"]->value() == Value{std::string{"x"}}
+              && rows[0]["c"]->value() == Value{1.5} && rows[0]["d"]->value() == Value{std::string{"X'0001'"}}, "row 1");
+        check(rows[1]["a"]->value().is_null() && rows[1]["b"]->value().is_null()
+              && rows[1]["c"]->value() == Value{2.5} && rows[1]["d"]->value() == Value{std::string{"NULL"}}, "row 2");
+        check(rows[2]["a"]->value() == Value{3} && rows[2]["b"]->value() == Value{std::string{"ąę"}}
+              && rows[2]["c"]->value().is_null() && rows[2]["d"]->value() == Value{std::string{"X''"}}, "row 3");
+        return failures;
+    }
+}
+
+int main(int const argc, char const* const argv[]) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s export|import <path>\n", argv[0]);
+        return 2;
+    }
+    if (!open_database()) {
+        std::fprintf(stderr, "the database can't be created\n");
+        return 1;
+    }
+    std::string_view const mode{argv[1]};
+    auto const result = mode == "export" ? export_stream(argv[2])
+                      : mode == "import" ? import_stream(argv[2])
+                      : 2;
+    SQLite::self().close();
+    logger::flush();
+    return result;
+}
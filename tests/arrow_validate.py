@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+# Validation of the Arrow IPC stream with pyarrow (run by ctest).
+#
+#   arrow_validate.py <sqlite_arrow_test> <output>  - export the stream and validate it,
+#   arrow_validate.py --write <path>                 - write the import fixture (tests/data/pyarrow.arrows).
+#
+# Exits with 77 (skipped) if pyarrow is not installed.
+
+import subprocess
+import sys
+
+try:
+    import pyarrow as pa
+except ImportError:
+    print("pyarrow is not installed, skipped")
+    sys.exit(77)
+
+
+def write_fixture(path):
+    table = pa.table({
+        "a": pa.array([1, None, 3], pa.int32()),
+        "b": pa.array(["x", None, "ąę"], pa.large_string()),
+        "c": pa.array([1.5, 2.5, None], pa.float32()),
+        "d": pa.array([b"\x00\x01", None, b""], pa.binary()),
+    })
+    with pa.OSFile(path, "wb") as file:
+        with pa.ipc.new_stream(file, table.schema) as writer:
+            writer.write_table(table, max_chunksize=2)
+
+
+def validate(program, path):
+    subprocess.run([program, "export", path], check=True)
+    with pa.OSFile(path, "rb") as file:
+        table = pa.ipc.open_stream(file).read_all()
+    table.validate(full=True)
+
+    expected = pa.schema([
+        ("id", pa.int64()),
+        ("name", pa.string()),
+        ("score", pa.float64()),
+        ("data", pa.binary()),
+        ("misc", pa.int64()),
+    ])
+    if not table.schema.equals(expected):
+        sys.exit(f"unexpected schema:\n{table.schema}")
+    if [column.num_chunks for column in table.columns] != [2] * 5:
+        sys.exit("expected 2 record batches")
+    if table.schema.field("id").metadata != {b"sqlite:declared_type": b"INTEGER"}:
+        sys.exit(f"unexpected metadata: {table.schema.field('id').metadata}")
+
+    rows = {
+        "id": [1, 2, 3, None],
+        "name": ["alice", None, "zażółć", ""],
+        "score": [1.5, None, -2.25, 0.0],
+        "data": [b"\x01\x02", None, b"", b"\xff"],
+        "misc": [7, 8, 9, None],
+    }
+    if table.to_pydict() != rows:
+        sys.exit(f"unexpected rows: {table.to_pydict()}")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) == 3 and sys.argv[1] == "--write":
+        write_fixture(sys.argv[2])
+    elif len(sys.argv) == 3:
+        validate(sys.argv[1], sys.argv[2])
+    else:
+        sys.exit(f"usage: {sys.argv[0]} <sqlite_arrow_test> <output> | --write <path>")
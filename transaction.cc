@@ -0,0 +1,170 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "transaction.h"
+#include "logger.h"
+#include "metrics.h"
+#include <format>
+
+/********************************************************************
+*                                                                   *
+*                           S T A T S                               *
+*                                                                   *
+********************************************************************/
+
+auto TransactionStats::
+committed(std::chrono::nanoseconds const duration) noexcept
+-> void {
+    auto const ns = duration.count();
+    commits_.fetch_add(1, std::memory_order_relaxed);
+    commit_ns_.fetch_add(ns, std::memory_order_relaxed);
+    auto max = max_commit_ns_.load(std::memory_order_relaxed);
+    while (ns > max && !max_commit_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+        ;
+}
+
+auto TransactionStats::
+snapshot() const noexcept
+-> Snapshot {
+    return {
+        .commits = commits_.load(std::memory_order_relaxed),
+        .rollbacks = rollbacks_.load(std::memory_order_relaxed),
+        .commit_time = std::chrono::nanoseconds{commit_ns_.load(std::memory_order_relaxed)},
+        .max_commit_time = std::chrono::nanoseconds{max_commit_ns_.load(std::memory_order_relaxed)}
+    };
+}
+
+/********************************************************************
+*                                                                   *
+*                       S A V E P O I N T                           *
+*                                                                   *
+********************************************************************/
+
+Savepoint::~Savepoint() {
+    if (active_)
+        rollback();
+}
+
+auto Savepoint::
+begin(sqlite3* const db) noexcept
+-> std::optional<Savepoint> {
+    // Names must differ only between nested savepoints, a process-wide counter is enough.
+    static std::atomic<u64> counter{};
+    auto name = std::format("sp_{}", counter.fetch_add(1, std::memory_order_relaxed));
+    if (SQLITE_OK == sqlite3_exec(db, std::format("SAVEPOINT {}", name).c_str(), nullptr, nullptr, nullptr))
+        return Savepoint{db, std::move(name)};
+    LOG_ERROR(db);
+    return {};
+}
+
+auto Savepoint::
+release() noexcept
+-> bool {
+    if (!active_)
+        return {};
+    if (SQLITE_OK == sqlite3_exec(db_, std::format("RELEASE {}", name_).c_str(), nullptr, nullptr, nullptr)) {
+        active_ = false;
+        return true;
+    }
+    LOG_ERROR(db_);
+    return {};
+}
+
+auto Savepoint::
+rollback() noexcept
+-> bool {
+    if (!active_)
+        return {};
+    active_ = false;
+    // ROLLBACK TO leaves the savepoint on the stack, it must be released too.
+    auto const sql = std::format("ROLLBACK TO {0}; RELEASE {0}", name_);
+    if (SQLITE_OK == sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, nullptr))
+        return true;
+    LOG_ERROR(db_);
+    return {};
+}
+
+/********************************************************************
+*                                                                   *
+*                     T R A N S A C T I O N                         *
+*                                                                   *
+********************************************************************/
+
+Transaction::~Transaction() {
+    if (active_)
+        rollback();
+}
+
+auto Transaction::
+begin(sqlite3* const db, Mode const mode, TransactionStats* const stats) noexcept
+-> std::optional<Transaction> {
+    auto const sql = [mode] {
+        switch (mode) {
+            case Mode::IMMEDIATE: return "BEGIN IMMEDIATE";
+            case Mode::EXCLUSIVE: return "BEGIN EXCLUSIVE";
+            default:              return "BEGIN DEFERRED";
+        }
+    }();
+    if (SQLITE_OK == sqlite3_exec(db, sql, nullptr, nullptr, nullptr))
+        return Transaction{db, stats};
+    LOG_ERROR(db);
+    return {};
+}
+
+auto Transaction::
+commit() noexcept
+-> bool {
+    if (!active_)
+        return {};
+
+    metrics::Timer const timer{metrics::COMMIT};
+    auto const start = std::chrono::steady_clock::now();
+    if (SQLITE_OK == sqlite3_exec(db_, "COMMIT", nullptr, nullptr, nullptr)) {
+        active_ = false;
+        if (stats_)
+            stats_->committed(std::chrono::steady_clock::now() - start);
+        return true;
+    }
+    LOG_ERROR(db_);
+    // The transaction can be closed by SQLite itself after some errors.
+    active_ = sqlite3_get_autocommit(db_) == 0;
+    return {};
+}
+
+auto Transaction::
+rollback() noexcept
+-> bool {
+    if (!active_)
+        return {};
+    active_ = false;
+    if (stats_)
+        stats_->rolled_back();
+    if (sqlite3_get_autocommit(db_) || SQLITE_OK == sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr))
+        return true;
+    LOG_ERROR(db_);
+    return {};
+}
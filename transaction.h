@@ -0,0 +1,131 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <utility>
+#include <sqlite3.h>
+
+/// Counters of transactions finished on one connection.
+class TransactionStats {
+    std::atomic<u64> commits_{};
+    std::atomic<u64> rollbacks_{};
+    std::atomic<i64> commit_ns_{};
+    std::atomic<i64> max_commit_ns_{};
+public:
+    struct Snapshot {
+        u64 commits{};
+        u64 rollbacks{};
+        std::chrono::nanoseconds commit_time{};      // total time spent in COMMIT
+        std::chrono::nanoseconds max_commit_time{};  // the longest COMMIT
+    };
+
+    void committed(std::chrono::nanoseconds duration) noexcept;
+    void rolled_back() noexcept {
+        rollbacks_.fetch_add(1, std::memory_order_relaxed);
+    }
+    [[nodiscard]] Snapshot snapshot() const noexcept;
+};
+
+/// Savepoint (nested transaction). \n
+/// Rolled back to when destroyed without release().
+class Savepoint {
+    sqlite3* db_{};
+    std::string name_{};
+    bool active_{};
+public:
+    ~Savepoint();
+    /// No Copy
+    Savepoint(Savepoint const&) = delete;
+    Savepoint& operator=(Savepoint const&) = delete;
+    /// Move
+    Savepoint(Savepoint&& rhs) noexcept
+        : db_{rhs.db_}, name_{std::move(rhs.name_)}, active_{std::exchange(rhs.active_, false)} {}
+    Savepoint& operator=(Savepoint&&) = delete;
+
+    /// Create the savepoint (inside or outside a transaction).
+    static std::optional<Savepoint> begin(sqlite3* db) noexcept;
+
+    /// Keep the changes made since the savepoint.
+    bool release() noexcept;
+    /// Undo the changes made since the savepoint.
+    bool rollback() noexcept;
+
+    [[nodiscard]] bool active() const noexcept {
+        return active_;
+    }
+
+private:
+    Savepoint(sqlite3* db, std::string name) : db_{db}, name_{std::move(name)}, active_{true} {}
+};
+
+/// Transaction guard. \n
+/// The transaction is rolled back when the guard is destroyed without commit().
+class Transaction {
+public:
+    enum class Mode { DEFERRED, IMMEDIATE, EXCLUSIVE };
+private:
+    sqlite3* db_{};
+    TransactionStats* stats_{};
+    bool active_{};
+public:
+    ~Transaction();
+    /// No Copy
+    Transaction(Transaction const&) = delete;
+    Transaction& operator=(Transaction const&) = delete;
+    /// Move
+    Transaction(Transaction&& rhs) noexcept
+        : db_{rhs.db_}, stats_{rhs.stats_}, active_{std::exchange(rhs.active_, false)} {}
+    Transaction& operator=(Transaction&&) = delete;
+
+    /// Begin the transaction in given mode. \n
+    /// IMMEDIATE takes the write lock at once, so the transaction can't fail later
+    /// with SQLITE_BUSY while upgrading its read lock.
+    static std::optional<Transaction> begin(sqlite3* db, Mode mode = Mode::DEFERRED, TransactionStats* stats = nullptr) noexcept;
+
+    /// Commit the changes. If the commit failed (e.g. SQLITE_BUSY),
+    /// the transaction remains open and commit can be repeated.
+    bool commit() noexcept;
+    /// Undo the changes.
+    bool rollback() noexcept;
+
+    /// Nested transaction.
+    [[nodiscard]] std::optional<Savepoint> savepoint() const noexcept {
+        return Savepoint::begin(db_);
+    }
+
+    [[nodiscard]] bool active() const noexcept {
+        return active_;
+    }
+
+private:
+    Transaction(sqlite3* db, TransactionStats* stats) : db_{db}, stats_{stats}, active_{true} {}
+};
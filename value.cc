@@ -37,18 +37,123 @@
 auto Value::
 to_bytes() const noexcept
 -> std::vector<char> {
-    auto const data = value_to_bytes();
-    u32 const chunk_size = static_cast<u32>(data.size());
+    std::vector<char> buffer(serialized_size());
+    Writer w{buffer};
+    write_to(w);
+    return buffer;
+}
 
-    std::vector<char> buffer{};
-    buffer.reserve(sizeof(char) + sizeof(u32) + chunk_size);
+auto Value::
+serialized_size() const noexcept
+-> size_t {
+    return sizeof(char) + sizeof(u32) + payload_size();
+}
+
+auto Value::
+write_to(Writer& w) const noexcept
+-> void {
+    w.put(marker());
+    w.put(static_cast<u32>(payload_size()));
+    switch (kind()) {
+        case INTEGER:
+            w.put(value<i64>());
+            break;
+        case DOUBLE:
+            w.put(value<f64>());
+            break;
+        case STRING: {
+            auto const v = text();
+            w.put(v.data(), v.size());
+            break;
+        }
+        case VECTOR: {
+            auto const v = blob();
+            w.put(v.data(), v.size());
+            break;
+        }
+        default:
+            break;
+    }
+}
 
-    buffer.push_back(marker());
-    std::copy_n(reinterpret_cast<u8 const*>(&chunk_size), sizeof(u32), std::back_inserter(buffer));
-    std::copy_n(data.data(), chunk_size, std::back_inserter(buffer));
-    buffer.shrink_to_fit();
+/********************************************************************
+*                                                                   *
+*                              V 2                                  *
+*                                                                   *
+********************************************************************/
 
-    return buffer;
+auto Value::
+encoded_size_v2() const noexcept
+-> size_t {
+    switch (kind()) {
+        case INTEGER: return sizeof(char) + wire::varint_size(wire::zigzag(value<i64>()));
+        case DOUBLE:  return sizeof(char) + sizeof(f64);
+        case STRING:  return sizeof(char) + wire::varint_size(text().size()) + text().size();
+        case VECTOR:  return sizeof(char) + wire::varint_size(blob().size()) + blob().size();
+        default:      return sizeof(char);
+    }
+}
+
+auto Value::
+encode_v2(Writer& w) const noexcept
+-> void {
+    w.put(marker());
+    switch (kind()) {
+        case INTEGER:
+            w.put_varint(wire::zigzag(value<i64>()));
+            break;
+        case DOUBLE:
+            w.put(value<f64>());
+            break;
+        case STRING: {
+            auto const v = text();
+            w.put_varint(v.size());
+            w.put(v.data(), v.size());
+            break;
+        }
+        case VECTOR: {
+            auto const v = blob();
+            w.put_varint(v.size());
+            w.put(v.data(), v.size());
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+auto Value::
+decode_v2(Reader& r) noexcept
+-> std::optional<Value> {
+    auto const type = r.get();
+    if (!type)
+        return {};
+    switch (*type) {
+        case 'M':
+            return Value{};
+        case 'I':
+            if (auto const v = r.varint())
+                return Value{wire::unzigzag(*v)};
+            return {};
+        case 'D':
+            if (auto const v = r.get<f64>())
+                return Value{*v};
+            return {};
+        case 'S':
+        case 'V': {
+            auto const size = r.varint();
+            if (!size)
+                return {};
+            auto const data = r.bytes(*size);
+            if (!data)
+                return {};
+            if (*type == 'S')
+                return Value{std::string{data->begin(), data->end()}};
+            return Value{std::vector<u8>{data->begin(), data->end()}};
+        }
+        default:
+            return {};
+    }
 }
 
 /********************************************************************
@@ -161,7 +266,7 @@ std::string Value::serialized_data(std::span<char> span) noexcept {
 auto Value::
 to_string() const noexcept
 -> std::string {
-    switch (data_.index()) {
+    switch (kind()) {
         case MONOSTATE:
             return "NULL"s;
         case INTEGER:
@@ -169,9 +274,9 @@ to_string() const noexcept
         case DOUBLE:
             return std::format("f64{{{}}}", value<f64>());
         case STRING:
-            return std::format("string{{{}}}", value<std::string>());
+            return std::format("string{{{}}}", text());
         case VECTOR: {
-            return std::format("blob{{{}}}", shared::hex_bytes_as_str(value<std::vector<u8>>()));
+            return std::format("blob{{{}}}", shared::hex_bytes_as_str(blob()));
         }
         default:
             return "?"s;
@@ -204,7 +309,7 @@ is_marker(char const c) noexcept
 auto Value::
 marker() const noexcept
 -> char {
-    switch (data_.index()) {
+    switch (kind()) {
         case MONOSTATE: return 'M';
         case INTEGER:   return 'I';
         case DOUBLE:    return 'D';
@@ -216,41 +321,18 @@ marker() const noexcept
 
 /********************************************************************
 *                                                                   *
-*                  V A L U E   T O   B Y T E S                      *
+*                    P A Y L O A D   S I Z E                        *
 *                                                                   *
 ********************************************************************/
 
 auto Value::
-value_to_bytes() const noexcept
--> std::vector<char> {
-    switch (data_.index()) {
-        case INTEGER: {
-            // i64 = 64 bity = 8 bajtów
-            std::vector<char> buffer(sizeof(i64));
-            auto const v = value<i64>();
-            memcpy(buffer.data(), &v, sizeof(i64));
-            return std::move(buffer);
-        }
-        case DOUBLE: {
-            // f64 = 64 bity = 8 bajtów.
-            std::vector<char> buffer(sizeof(f64));
-            auto const v = value<f64>();
-            memcpy(buffer.data(), &v, sizeof(f64));
-            return std::move(buffer);
-        }
-        case STRING: {
-            auto const v = value<std::string>();
-            std::vector<char> buffer(v.size());
-            memcpy(buffer.data(), v.data(), v.size());
-            return std::move(buffer);
-        }
-        case VECTOR: {
-            auto const v = value<std::vector<u8>>();
-            std::vector<char> buffer(v.size());
-            memcpy(buffer.data(), v.data(), v.size());
-            return std::move(buffer);
-        }
-        default:
-            return {};
+payload_size() const noexcept
+-> size_t {
+    switch (kind()) {
+        case INTEGER: return sizeof(i64);
+        case DOUBLE:  return sizeof(f64);
+        case STRING:  return text().size();
+        case VECTOR:  return blob().size();
+        default:      return 0;
     }
 }
@@ -28,6 +28,8 @@
 -------------------------------------------------------------------*/
 #include "types.h"
 #include "shared.h"
+#include "writer.h"
+#include "reader.h"
 #include <variant>
 #include <optional>
 #include <span>
@@ -36,9 +38,10 @@
 namespace rng = ranges;
 
 class Value {
-    std::variant<std::monostate, i64, f64, std::string, std::vector<u8>> data_{};
+    std::variant<std::monostate, i64, f64, std::string, std::vector<u8>, std::string_view, std::span<const u8>> data_{};
 public:
-    enum { MONOSTATE, INTEGER, DOUBLE, STRING, VECTOR };
+    /// STRING_REF and VECTOR_REF are non-owning text and blob (see Value::ref).
+    enum { MONOSTATE, INTEGER, DOUBLE, STRING, VECTOR, STRING_REF, VECTOR_REF };
 
     Value() = default;
     ~Value() = default;
@@ -50,6 +53,19 @@ public:
     explicit Value(std::string_view v) : data_{std::string(v)} {}
     explicit Value(std::vector<u8> v) : data_{std::move(v)} {}
 
+    /// Non-owning values. The referenced data must outlive the Value
+    /// (and the statement step the Value is bound to).
+    static Value ref(std::string_view const v) noexcept {
+        Value value{};
+        value.data_ = v;
+        return value;
+    }
+    static Value ref(std::span<const u8> const v) noexcept {
+        Value value{};
+        value.data_ = v;
+        return value;
+    }
+
     /// Constructor dedicated to optional values
     template<typename T>
     explicit Value(std::optional<T> v) noexcept {
@@ -69,14 +85,58 @@ public:
     }
 
     /// Take the index of the contained value.
-    /// i.e. MONOSTATE, INTEGER, DOUBLE, STRING, VECTOR
+    /// i.e. MONOSTATE, INTEGER, DOUBLE, STRING, VECTOR, STRING_REF, VECTOR_REF
     [[nodiscard]] uint index() const noexcept {
         return data_.index();
     }
+    /// Take the kind of the contained value, owning or not.
+    /// i.e. MONOSTATE, INTEGER, DOUBLE, STRING, VECTOR
+    [[nodiscard]] uint kind() const noexcept {
+        switch (auto const idx = data_.index()) {
+            case STRING_REF: return STRING;
+            case VECTOR_REF: return VECTOR;
+            default: return idx;
+        }
+    }
+    /// Check if the object refers to data it does not own.
+    [[nodiscard]] bool is_ref() const noexcept {
+        return data_.index() >= STRING_REF;
+    }
+
+    /// View of the text (owning or not) without copying (empty for other kinds).
+    [[nodiscard]] std::string_view text() const noexcept {
+        if (auto const p = std::get_if<std::string>(&data_))
+            return *p;
+        if (auto const p = std::get_if<std::string_view>(&data_))
+            return *p;
+        return {};
+    }
+    /// View of the blob (owning or not) without copying (empty for other kinds).
+    [[nodiscard]] std::span<const u8> blob() const noexcept {
+        if (auto const p = std::get_if<std::vector<u8>>(&data_))
+            return *p;
+        if (auto const p = std::get_if<std::span<const u8>>(&data_))
+            return *p;
+        return {};
+    }
 
     /// Serialization. Converting a Field to bytes.
     [[nodiscard]] auto to_bytes() const noexcept
     -> std::vector<char>;
+    /// Number of bytes of the serialized value.
+    [[nodiscard]] auto serialized_size() const noexcept
+    -> size_t;
+    /// Serialization directly into the writer.
+    auto write_to(Writer& w) const noexcept
+    -> void;
+
+    /// V2 encoding of the value inside of V2 frame (marker and varint based payload).
+    [[nodiscard]] auto encoded_size_v2() const noexcept
+    -> size_t;
+    auto encode_v2(Writer& w) const noexcept
+    -> void;
+    static auto decode_v2(Reader& r) noexcept
+    -> std::optional<Value>;
 
     /// Deserialization. Recreate Field from bytes.
     static auto from_bytes(std::span<const char> span) noexcept
@@ -111,8 +171,17 @@ public:
         return {};
     }
 
+    /// Owning and non-owning values are equal if their contents are equal.
     bool operator==(Value const& rhs) const noexcept {
-        return (data_.index() == rhs.data_.index()) && (data_ == rhs.data_);
+        if (kind() != rhs.kind())
+            return false;
+        switch (kind()) {
+            case INTEGER: return std::get<i64>(data_) == std::get<i64>(rhs.data_);
+            case DOUBLE:  return std::get<f64>(data_) == std::get<f64>(rhs.data_);
+            case STRING:  return text() == rhs.text();
+            case VECTOR:  return std::ranges::equal(blob(), rhs.blob());
+            default:      return true;
+        }
     }
     bool operator!=(Value const& rhs) const noexcept {
         return !operator==(rhs);
@@ -128,6 +197,6 @@ private:
     /// Return marker for current value;
     [[nodiscard]] auto marker() const noexcept -> char;
 
-    /// Return serialize value.
-    [[nodiscard]] auto value_to_bytes() const noexcept -> std::vector<char>;
+    /// Return the number of bytes of serialized value (without marker and chunk size).
+    [[nodiscard]] auto payload_size() const noexcept -> size_t;
 };
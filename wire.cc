@@ -0,0 +1,422 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "wire.h"
+#include <cstring>
+
+namespace wire {
+    namespace {
+        /// Content of the chunk (marker, u32 size, content) at the beginning of the span.
+        auto chunk(std::span<const char> const span, char const marker) noexcept
+        -> std::optional<std::span<const char>> {
+            constexpr size_t header_size = sizeof(char) + sizeof(u32);
+            if (span.size() < header_size || span.front() != marker)
+                return {};
+            auto const size = shared::from<u32>(span.subspan(1));
+            if (!size || span.size() - header_size < *size)
+                return {};
+            return span.subspan(header_size, *size);
+        }
+
+        template<typename T>
+        auto load(std::span<const char> const span) noexcept -> T {
+            T v{};
+            std::memcpy(&v, span.data(), sizeof(T));
+            return v;
+        }
+
+        /// Count of elements at the beginning of the chunk content.
+        template<typename T>
+        auto elements(std::span<const char> const content) noexcept
+        -> std::pair<std::optional<T>,std::span<const char>> {
+            if (content.size() < sizeof(T))
+                return {};
+            return {load<T>(content), content.subspan(sizeof(T))};
+        }
+
+        /// Parse all elements, true if all of them are well-formed.
+        template<typename T>
+        auto walk(std::span<const char> span, size_t count, Version const version) noexcept -> bool {
+            for (; count; --count) {
+                auto const [element, nbytes] = T::parse(span, version);
+                if (nbytes == 0)
+                    return false;
+                if constexpr (requires { element.valid(); })
+                    if (!element.valid())
+                        return false;
+                span = span.subspan(nbytes);
+            }
+            return span.empty();
+        }
+    }
+
+    /********************************************************************
+    *                                                                   *
+    *                       V A L U E   V I E W                         *
+    *                                                                   *
+    ********************************************************************/
+
+    auto ValueView::
+    parse(std::span<const char> const span, Version const version) noexcept
+    -> std::pair<ValueView,size_t> {
+        if (span.empty())
+            return {};
+        auto const marker = span.front();
+
+        if (version == V2) {
+            // marker and payload: nothing ('M'), zig-zag varint ('I'), f64 ('D'), varint size and bytes ('S', 'V')
+            ValueView view{};
+            view.marker_ = marker;
+            view.version_ = V2;
+            Reader r{span.subspan(1)};
+            switch (marker) {
+                case 'M':
+                    break;
+                case 'I':
+                    if (!r.varint())
+                        return {};
+                    view.payload_ = span.subspan(1, r.consumed());
+                    break;
+                case 'D': {
+                    auto const data = r.bytes(sizeof(f64));
+                    if (!data)
+                        return {};
+                    view.payload_ = *data;
+                    break;
+                }
+                case 'S':
+                case 'V': {
+                    auto const size = r.varint();
+                    auto const data = size ? r.bytes(*size) : std::nullopt;
+                    if (!data)
+                        return {};
+                    view.payload_ = *data;
+                    break;
+                }
+                default:
+                    return {};
+            }
+            return {view, sizeof(char) + r.consumed()};
+        }
+
+        auto const payload = chunk(span, marker);
+        if (!payload)
+            return {};
+        switch (marker) {
+            case 'I':
+            case 'D':
+                if (payload->size() != sizeof(i64))
+                    return {};
+                break;
+            case 'S':
+            case 'V':
+            case 'M':
+                break;
+            default:
+                return {};
+        }
+        ValueView view{};
+        view.marker_ = marker;
+        view.payload_ = *payload;
+        return {view, sizeof(char) + sizeof(u32) + payload->size()};
+    }
+
+    auto ValueView::
+    kind() const noexcept
+    -> uint {
+        switch (marker_) {
+            case 'I': return Value::INTEGER;
+            case 'D': return Value::DOUBLE;
+            case 'S': return Value::STRING;
+            case 'V': return Value::VECTOR;
+            default:  return Value::MONOSTATE;
+        }
+    }
+
+    auto ValueView::
+    integer() const noexcept
+    -> std::optional<i64> {
+        if (marker_ != 'I')
+            return {};
+        if (version_ == V2) {
+            if (auto const v = Reader{payload_}.varint())
+                return unzigzag(*v);
+            return {};
+        }
+        return load<i64>(payload_);
+    }
+
+    auto ValueView::
+    real() const noexcept
+    -> std::optional<f64> {
+        if (marker_ == 'D')
+            return load<f64>(payload_);
+        return {};
+    }
+
+    auto ValueView::
+    text() const noexcept
+    -> std::optional<std::string_view> {
+        if (marker_ == 'S')
+            return std::string_view{payload_.data(), payload_.size()};
+        return {};
+    }
+
+    auto ValueView::
+    blob() const noexcept
+    -> std::optional<std::span<const u8>> {
+        if (marker_ == 'V')
+            return std::span{reinterpret_cast<u8 const*>(payload_.data()), payload_.size()};
+        return {};
+    }
+
+    auto ValueView::
+    to_value() const
+    -> Value {
+        switch (marker_) {
+            case 'I': return Value{*integer()};
+            case 'D': return Value{*real()};
+            case 'S': return Value{*text()};
+            case 'V': {
+                auto const v = *blob();
+                return Value{std::vector<u8>{v.begin(), v.end()}};
+            }
+            default:  return {};
+        }
+    }
+
+    /********************************************************************
+    *                                                                   *
+    *                       F I E L D   V I E W                         *
+    *                                                                   *
+    ********************************************************************/
+
+    auto FieldView::
+    parse(std::span<const char> const span, Version const version) noexcept
+    -> std::pair<FieldView,size_t> {
+        if (version == V2) {
+            // varint size of the name, name, value
+            Reader r{span};
+            auto const name_size = r.varint();
+            auto const name = name_size ? r.bytes(*name_size) : std::nullopt;
+            if (!name)
+                return {};
+            auto const [value, nbytes] = ValueView::parse(span.subspan(r.consumed()), V2);
+            if (nbytes == 0)
+                return {};
+
+            FieldView view{};
+            view.name_ = std::string_view{name->data(), name->size()};
+            view.value_ = value;
+            return {view, r.consumed() + nbytes};
+        }
+
+        auto const content = chunk(span, 'F');
+        if (!content)
+            return {};
+        auto const [name_size, rest] = elements<u16>(*content);
+        if (!name_size || rest.size() < *name_size)
+            return {};
+        auto const [value, nbytes] = ValueView::parse(rest.subspan(*name_size));
+        // the value must fill the rest of the chunk
+        if (nbytes == 0 || *name_size + nbytes != rest.size())
+            return {};
+
+        FieldView view{};
+        view.name_ = std::string_view{rest.data(), *name_size};
+        view.value_ = value;
+        return {view, sizeof(char) + sizeof(u32) + content->size()};
+    }
+
+    auto FieldView::
+    to_field() const
+    -> Field {
+        return Field{std::string{name_}, value_.to_value()};
+    }
+
+    /********************************************************************
+    *                                                                   *
+    *                         R O W   V I E W                           *
+    *                                                                   *
+    ********************************************************************/
+
+    auto RowView::
+    parse(std::span<const char> const span, Version const version) noexcept
+    -> std::pair<RowView,size_t> {
+        if (version == V2) {
+            // varint count of fields, fields (the row ends after its last field)
+            Reader r{span};
+            auto const count = r.varint();
+            if (!count)
+                return {};
+            auto const header = r.consumed();
+            auto rest = span.subspan(header);
+            for (auto i = *count; i; --i) {
+                auto const [field, nbytes] = FieldView::parse(rest, V2);
+                if (nbytes == 0)
+                    return {};
+                rest = rest.subspan(nbytes);
+            }
+
+            size_t const nbytes = span.size() - rest.size();
+            RowView view{};
+            view.bytes_ = span.first(nbytes);
+            view.fields_ = span.subspan(header, nbytes - header);
+            view.count_ = *count;
+            view.version_ = V2;
+            return {view, nbytes};
+        }
+
+        auto const content = chunk(span, 'R');
+        if (!content)
+            return {};
+        auto const [count, fields] = elements<u16>(*content);
+        if (!count)
+            return {};
+
+        size_t const nbytes = sizeof(char) + sizeof(u32) + content->size();
+        RowView view{};
+        view.bytes_ = span.first(nbytes);
+        view.fields_ = fields;
+        view.count_ = *count;
+        return {view, nbytes};
+    }
+
+    auto RowView::
+    find(std::string_view const name) const noexcept
+    -> std::optional<FieldView> {
+        for (auto it = begin(); it != end(); ++it)
+            if (it->name() == name)
+                return *it;
+        return {};
+    }
+
+    auto RowView::
+    valid() const noexcept
+    -> bool {
+        return walk<FieldView>(fields_, count_, version_);
+    }
+
+    auto RowView::
+    to_row() const
+    -> Row {
+        Row row{};
+        for (auto it = begin(); it != end(); ++it)
+            row.add(it->to_field());
+        return row;
+    }
+
+    /********************************************************************
+    *                                                                   *
+    *                      R E S U L T   V I E W                        *
+    *                                                                   *
+    ********************************************************************/
+
+    auto ResultView::
+    parse(std::span<const char> const span) noexcept
+    -> std::pair<ResultView,size_t> {
+        if (!span.empty() && span.front() == 't') {
+            // marker, version, varint size of the body, body (varint count of rows, rows)
+            Reader r{span};
+            if (r.get() != 't' || r.get<u8>() != V2)
+                return {};
+            auto const size = r.varint();
+            auto const body = size ? r.bytes(*size) : std::nullopt;
+            if (!body)
+                return {};
+            Reader b{*body};
+            auto const count = b.varint();
+            if (!count)
+                return {};
+
+            ResultView view{};
+            view.bytes_ = span.first(r.consumed());
+            view.rows_ = body->subspan(b.consumed());
+            view.count_ = *count;
+            view.version_ = V2;
+            return {view, r.consumed()};
+        }
+
+        auto const content = chunk(span, 'T');
+        if (!content)
+            return {};
+        auto const [count, rows] = elements<u16>(*content);
+        if (!count)
+            return {};
+
+        size_t const nbytes = sizeof(char) + sizeof(u32) + content->size();
+        ResultView view{};
+        view.bytes_ = span.first(nbytes);
+        view.rows_ = rows;
+        view.count_ = *count;
+        return {view, nbytes};
+    }
+
+    auto ResultView::
+    at(size_t idx) const noexcept
+    -> std::optional<RowView> {
+        if (idx >= count_)
+            return {};
+        if (version_ == V2) {
+            auto it = begin();
+            for (; idx && it != end(); --idx)
+                ++it;
+            if (it == end())
+                return {};
+            return *it;
+        }
+        auto span = rows_;
+        for (;;) {
+            // only the chunk header of the skipped rows is read
+            auto const content = chunk(span, 'R');
+            if (!content)
+                return {};
+            if (idx-- == 0)
+                break;
+            span = span.subspan(sizeof(char) + sizeof(u32) + content->size());
+        }
+        auto const [row, nbytes] = RowView::parse(span);
+        if (nbytes == 0)
+            return {};
+        return row;
+    }
+
+    auto ResultView::
+    valid() const noexcept
+    -> bool {
+        return walk<RowView>(rows_, count_, version_);
+    }
+
+    auto ResultView::
+    to_result() const
+    -> Result {
+        Result result{};
+        for (auto it = begin(); it != end(); ++it)
+            result.add(it->to_row());
+        return result;
+    }
+}
@@ -0,0 +1,217 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include "result.h"
+#include "reader.h"
+#include <span>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+/// Zero-copy views of serialized data in V1 and V2 formats (see to_bytes()). \n
+/// The views parse the bytes in place, they never allocate and never copy,
+/// so the viewed bytes must outlive them. Every access is bounds-checked,
+/// malformed data ends the traversal (or gives an empty result), never reads past the span.
+namespace wire {
+    /// Forward iterator over consecutive serialized elements (fields of a row, rows of a result).
+    /// Each element is parsed only when the iterator gets to it.
+    template<typename T>
+    class Iterator {
+        std::span<const char> rest_{};
+        size_t left_{};
+        Version version_{V1};
+        T current_{};
+        bool valid_{};
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        Iterator(std::span<const char> const span, size_t const count, Version const version = V1) noexcept
+            : rest_{span}, left_{count}, version_{version} {
+            advance();
+        }
+
+        T const& operator*() const noexcept {
+            return current_;
+        }
+        T const* operator->() const noexcept {
+            return &current_;
+        }
+        Iterator& operator++() noexcept {
+            advance();
+            return *this;
+        }
+        Iterator operator++(int) noexcept {
+            auto tmp = *this;
+            advance();
+            return tmp;
+        }
+        bool operator==(Iterator const& rhs) const noexcept {
+            if (!valid_ || !rhs.valid_)
+                return valid_ == rhs.valid_;
+            return rest_.data() == rhs.rest_.data();
+        }
+        bool operator==(std::default_sentinel_t) const noexcept {
+            return !valid_;
+        }
+    private:
+        void advance() noexcept {
+            valid_ = false;
+            if (left_ == 0)
+                return;
+            auto const [element, nbytes] = T::parse(rest_, version_);
+            if (nbytes == 0) {
+                left_ = 0;      // malformed data, stop here
+                return;
+            }
+            current_ = element;
+            rest_ = rest_.subspan(nbytes);
+            --left_;
+            valid_ = true;
+        }
+    };
+
+    /// View of a serialized Value.
+    class ValueView {
+        char marker_{'M'};
+        Version version_{V1};
+        std::span<const char> payload_{};   // V2 integer: its zig-zag varint
+    public:
+        /// Parse the value at the beginning of the span.
+        /// Returns the view and the number of consumed bytes (0 if the data is malformed).
+        static auto parse(std::span<const char> span, Version version = V1) noexcept -> std::pair<ValueView,size_t>;
+
+        /// Kind of the value, i.e. Value::MONOSTATE, INTEGER, DOUBLE, STRING, VECTOR.
+        [[nodiscard]] uint kind() const noexcept;
+        [[nodiscard]] bool is_null() const noexcept {
+            return kind() == Value::MONOSTATE;
+        }
+        [[nodiscard]] auto integer() const noexcept -> std::optional<i64>;
+        [[nodiscard]] auto real() const noexcept -> std::optional<f64>;
+        [[nodiscard]] auto text() const noexcept -> std::optional<std::string_view>;
+        [[nodiscard]] auto blob() const noexcept -> std::optional<std::span<const u8>>;
+        /// Create the owning value (copies text and blob).
+        [[nodiscard]] auto to_value() const -> Value;
+    };
+
+    /// View of a serialized Field.
+    class FieldView {
+        std::string_view name_{};
+        ValueView value_{};
+    public:
+        static auto parse(std::span<const char> span, Version version = V1) noexcept -> std::pair<FieldView,size_t>;
+
+        [[nodiscard]] std::string_view name() const noexcept {
+            return name_;
+        }
+        [[nodiscard]] ValueView const& value() const noexcept {
+            return value_;
+        }
+        [[nodiscard]] auto to_field() const -> Field;
+    };
+
+    /// View of a serialized Row.
+    class RowView {
+        std::span<const char> bytes_{};
+        std::span<const char> fields_{};
+        size_t count_{};
+        Version version_{V1};
+    public:
+        /// V2 rows have no size, parsing of the row checks all its fields.
+        static auto parse(std::span<const char> span, Version version = V1) noexcept -> std::pair<RowView,size_t>;
+
+        /// Number of fields declared in the row.
+        [[nodiscard]] size_t size() const noexcept {
+            return count_;
+        }
+        [[nodiscard]] bool empty() const noexcept {
+            return count_ == 0;
+        }
+        [[nodiscard]] auto begin() const noexcept -> Iterator<FieldView> {
+            return {fields_, count_, version_};
+        }
+        [[nodiscard]] static auto end() noexcept -> std::default_sentinel_t {
+            return {};
+        }
+        /// Find the field by name (linear scan, nothing is decoded except names).
+        [[nodiscard]] auto find(std::string_view name) const noexcept -> std::optional<FieldView>;
+        [[nodiscard]] auto operator[](std::string_view const name) const noexcept -> std::optional<FieldView> {
+            return find(name);
+        }
+        /// Serialized bytes of the whole row (e.g. to forward it).
+        [[nodiscard]] std::span<const char> bytes() const noexcept {
+            return bytes_;
+        }
+        /// Check that all fields are well-formed.
+        [[nodiscard]] bool valid() const noexcept;
+        [[nodiscard]] auto to_row() const -> Row;
+    };
+
+    /// View of a serialized Result.
+    class ResultView {
+        std::span<const char> bytes_{};
+        std::span<const char> rows_{};
+        size_t count_{};
+        Version version_{V1};
+    public:
+        /// Parse the result in V1 ('T') or V2 ('t') format (compressed results must be decompressed first).
+        static auto parse(std::span<const char> span) noexcept -> std::pair<ResultView,size_t>;
+
+        /// Format version of the viewed bytes.
+        [[nodiscard]] Version version() const noexcept {
+            return version_;
+        }
+
+        /// Number of rows declared in the result.
+        [[nodiscard]] size_t size() const noexcept {
+            return count_;
+        }
+        [[nodiscard]] bool empty() const noexcept {
+            return count_ == 0;
+        }
+        [[nodiscard]] auto begin() const noexcept -> Iterator<RowView> {
+            return {rows_, count_, version_};
+        }
+        [[nodiscard]] static auto end() noexcept -> std::default_sentinel_t {
+            return {};
+        }
+        /// Row at the index (V1 rows are skipped using their sizes, fields are not parsed,
+        /// V2 rows have no sizes and are parsed up to the index).
+        [[nodiscard]] auto at(size_t idx) const noexcept -> std::optional<RowView>;
+        /// Serialized bytes of the whole result (e.g. to forward it).
+        [[nodiscard]] std::span<const char> bytes() const noexcept {
+            return bytes_;
+        }
+        /// Check that all rows (and their fields) are well-formed.
+        [[nodiscard]] bool valid() const noexcept;
+        [[nodiscard]] auto to_result() const -> Result;
+    };
+}
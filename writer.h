@@ -0,0 +1,109 @@
+// MIT License
+//
+// Copyright (c) 2024 Piotr Pszczółkowski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Created by Piotr Pszczółkwski on 16.10.2026 (piotr@beesoft.pl).
+//
+#pragma once
+
+/*------- include files:
+-------------------------------------------------------------------*/
+#include "types.h"
+#include <span>
+#include <cstring>
+#include <type_traits>
+
+namespace wire {
+    /// Versions of the serialization format. \n
+    /// V1: fixed-size numbers, u16 counts and u32 chunk sizes (every element has marker and size). \n
+    /// V2: LEB128 varints for sizes and counts, zig-zag varints for integers, no 16-bit limits.
+    ///     Frame: lowercase marker, version byte, varint size of the body, body.
+    enum Version : u8 { V1 = 1, V2 = 2 };
+
+    constexpr u64 zigzag(i64 const v) noexcept {
+        return (static_cast<u64>(v) << 1) ^ static_cast<u64>(v >> 63);
+    }
+    constexpr i64 unzigzag(u64 const v) noexcept {
+        return static_cast<i64>(v >> 1) ^ -static_cast<i64>(v & 1);
+    }
+    /// Maximal number of bytes of the LEB128 varint of u64.
+    constexpr size_t MAX_VARINT_SIZE{10};
+    /// Number of bytes of the LEB128 varint.
+    constexpr size_t varint_size(u64 v) noexcept {
+        size_t n = 1;
+        for (; v >= 0x80; v >>= 7)
+            ++n;
+        return n;
+    }
+}
+
+/// Single-pass serializer. \n
+/// All levels (Query, Result, Row, Field, Value) are written directly into one
+/// caller-supplied buffer, which must be large enough (see 'serialized_size()').
+/// Chunk sizes are reserved first and back-patched when the chunk is complete.
+class Writer {
+    std::span<char> buffer_;
+    size_t pos_{};
+public:
+    explicit Writer(std::span<char> buffer) noexcept : buffer_{buffer} {}
+    /// No Copy
+    Writer(Writer const&) = delete;
+    Writer& operator=(Writer const&) = delete;
+
+    /// Number of bytes written so far.
+    [[nodiscard]] size_t size() const noexcept {
+        return pos_;
+    }
+
+    void put(char const c) noexcept {
+        buffer_[pos_++] = c;
+    }
+    /// Write trivially copyable number (native byte order, like the rest of the format).
+    template<typename T>
+        requires std::is_arithmetic_v<T>
+    void put(T const v) noexcept {
+        std::memcpy(buffer_.data() + pos_, &v, sizeof(T));
+        pos_ += sizeof(T);
+    }
+    void put(void const* data, size_t const n) noexcept {
+        if (n) std::memcpy(buffer_.data() + pos_, data, n);
+        pos_ += n;
+    }
+
+    /// Write LEB128 varint.
+    void put_varint(u64 v) noexcept {
+        for (; v >= 0x80; v >>= 7)
+            put(static_cast<char>(v | 0x80));
+        put(static_cast<char>(v));
+    }
+
+    /// Reserve space for the size of a chunk, returns its position.
+    [[nodiscard]] size_t begin_chunk() noexcept {
+        auto const pos = pos_;
+        pos_ += sizeof(u32);
+        return pos;
+    }
+    /// Patch the chunk size reserved at 'pos' (the size does not include itself).
+    void end_chunk(size_t const pos) noexcept {
+        u32 const chunk_size = pos_ - pos - sizeof(u32);
+        std::memcpy(buffer_.data() + pos, &chunk_size, sizeof(u32));
+    }
+};